@@ -0,0 +1,421 @@
+/* [ bench.c ] - Guitar Tuner DSP Benchmark
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Compare the FFTW (double) path against the fixed-point one on
+ * synthetic notes: reports the worst difference in cents and the
+ * time spent per frame by each path, and the time spent by the
+ * Intonation Mode on a long window with 1 and all the CPUs.
+ *     $ make guitartuner-bench && ./guitartuner-bench [ frames ]
+ *
+ * Tolerance: the fixed path must find the same peak bin, or the next
+ * one when rounding breaks a tie. One bin is sampling rate / NSAMPLES
+ * (1.35Hz at 22050Hz), that's 28 cents at E2 and 5.3 cents at A4.
+ * Every note is also pushed in uneven chunks: tuner_process() must
+ * find the same peak bin as with a single push of the frame.
+ *
+ * Readings: the whole fixed-point tuner (bench_fixed.c, noise threshold
+ * and Q16.16 note mapping) must give the same note, reference and
+ * adjust as the float one, but at the noise threshold (1%) or when the
+ * peak tie above moves it to the next bin.
+ *
+ * Intonation Mode: strings from E1 to A4 with inharmonicity B from 0
+ * to 1e-3, the fundamental must be within INTONATION_MAX_CENTS and
+ * B within INTONATION_MAX_B_ERROR (relative) + INTONATION_MIN_B.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* Standard Headers */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "tuner.h"
+#include "fixed.h"
+
+/* Detune (cents) applied to every reference note */
+#define BENCH_DETUNE_CENTS	(7.0)
+
+/* Equal Tempered Notes from C2 to B5, in Semitones from A4 */
+#define BENCH_NOTE_FIRST	(-33)
+#define BENCH_NOTE_LAST		(14)
+
+#define BENCH_SAMPLING_FREQ	(22050)
+
+/* Float vs Fixed Readings: Detunes (cents) and Amplitudes (8 Bit),
+ * some of them right around the Noise Threshold (TUNER_POWER_MIN).
+ */
+static const double READING_DETUNES[] = { -45.0, -30.0, -15.0, 0.0, 15.0, 30.0, 45.0 };
+static const double READING_AMPLITUDES[] = { 20.0, 22.0, 23.0, 24.0, 26.0, 60.0, 100.0 };
+#define READING_NOISE_MARGIN	(0.01)
+
+/* Intonation Mode Tolerance */
+#define INTONATION_MAX_CENTS	(0.5)
+#define INTONATION_MAX_B_ERROR	(0.1)
+#define INTONATION_MIN_B		(2e-5)
+
+/* Strings (E1, A1, E2, A2, D3, G3, E4, A4) and Inharmonicity */
+static const double INTONATION_NOTES[] = {
+	41.2034, 55.0, 82.4069, 110.0, 146.832, 195.998, 329.628, 440.0
+};
+static const double INTONATION_B[] = { 0.0, 1e-4, 5e-4, 1e-3 };
+
+/* Push API Chunk Sizes, cycled: the Frame ends inside some of them */
+static const unsigned int BENCH_CHUNKS[] = { 1, 7, 1000, 4093, 64, 3 };
+#define BENCH_NCHUNKS		(sizeof(BENCH_CHUNKS) / sizeof(BENCH_CHUNKS[0]))
+
+/* The Fixed-Point tuner_*(), tuner.c built with TUNER_FIXED_POINT */
+GuitarTuner *bench_fixed_tuner_new (int sampling_frequency);
+void bench_fixed_tuner_free (GuitarTuner *tuner);
+int bench_fixed_tuner_process (GuitarTuner *tuner,
+							   const void *samples, size_t n,
+							   GuitarTunerFormat format,
+							   GuitarTunerResult *result);
+
+static GuitarTuner *tuner;
+static GuitarTunerResult result;
+static unsigned char samples[NSAMPLES];
+static unsigned char stream[2 * NSAMPLES];
+static short intonation_samples[TUNER_INTONATION_NSAMPLES];
+
+/* The Q15 Tables are the ones Shipped in tables.c */
+static int fixed_data[NSAMPLES];
+
+/* Note + 2nd Harmonic + Some Noise, 8 Bit like the device */
+static void bench_signal (double freq, double amplitude, unsigned int seed) {
+	unsigned int i;
+	double v;
+
+	for (i=0; i < NSAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		v = amplitude * sin(2.0 * M_PI * freq * i / BENCH_SAMPLING_FREQ) +
+			amplitude * 25.0 / 60.0 * sin(4.0 * M_PI * freq * i / BENCH_SAMPLING_FREQ) +
+			(double) ((seed >> 16) % 7) - 3.0;
+		samples[i] = (unsigned char) (128 + (int) floor(v + 0.5));
+	}
+}
+
+static unsigned int bench_fixed_peak (long long *max) {
+	fixed_load_u8(fixed_data, samples, TUNER_FIXED_WINDOW, NSAMPLES);
+	fixed_fft(fixed_data, TUNER_FIXED_COSINE, NSAMPLES);
+	return(fixed_peak(fixed_data, TUNER_FIXED_COSINE,
+					  NSAMPLES, 2, NSAMPLES/16, max));
+}
+
+/* Push two Copies of the Frame in Chunks, both must find the peak
+ * bin of a single push (index). Returns the Frames that didn't.
+ */
+static unsigned int bench_chunks (unsigned int index) {
+	unsigned int pos = 0, c = 0;
+	unsigned int frames = 0, bad = 0;
+	unsigned int count;
+
+	memcpy(stream, samples, NSAMPLES);
+	memcpy(stream + NSAMPLES, samples, NSAMPLES);
+
+	while (pos < 2 * NSAMPLES) {
+		count = BENCH_CHUNKS[c++ % BENCH_NCHUNKS];
+		if (count > 2 * NSAMPLES - pos)
+			count = 2 * NSAMPLES - pos;
+
+		if (tuner_process(tuner, stream + pos, count, TUNER_FORMAT_U8, &result) > 0) {
+			if (tuner->max_index != index) bad++;
+			frames++;
+		}
+
+		pos += count;
+	}
+
+	return(bad + 2 - frames);
+}
+
+static double bench_elapsed (const struct timeval *start) {
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return((now.tv_sec - start->tv_sec) * 1000.0 +
+		   (now.tv_usec - start->tv_usec) / 1000.0);
+}
+
+/* Float and Fixed tuner_process() on the same Notes: the Readings
+ * (note, reference, adjust) must be the same, but where the fixed
+ * rounding may tip them: float power within READING_NOISE_MARGIN of
+ * TUNER_POWER_MIN, or the peak on the next bin. Returns the Readings
+ * that differ, allowed is how many of them were Tolerated.
+ */
+static unsigned int bench_readings (GuitarTuner *fixed_tuner, unsigned int *tested,
+									unsigned int *allowed)
+{
+	GuitarTunerResult fixed_result;
+	unsigned int differ = 0;
+	unsigned int i, j;
+	double freq, bin;
+	int note;
+
+	bin = (double) BENCH_SAMPLING_FREQ / NSAMPLES;
+	*tested = 0;
+	*allowed = 0;
+	for (note=BENCH_NOTE_FIRST; note <= BENCH_NOTE_LAST; note++) {
+		for (i=0; i < sizeof(READING_DETUNES) / sizeof(READING_DETUNES[0]); i++) {
+			for (j=0; j < sizeof(READING_AMPLITUDES) / sizeof(READING_AMPLITUDES[0]); j++) {
+				freq = 440.0 * pow(2.0, (note * 100.0 + READING_DETUNES[i]) / 1200.0);
+				bench_signal(freq, READING_AMPLITUDES[j], *tested);
+				(*tested)++;
+
+				tuner_process(tuner, samples, NSAMPLES, TUNER_FORMAT_U8, &result);
+				bench_fixed_tuner_process(fixed_tuner, samples, NSAMPLES, 
+										  TUNER_FORMAT_U8, &fixed_result);
+
+				if (result.note == NULL || fixed_result.note == NULL) {
+					if (result.note == fixed_result.note)
+						continue;
+				} else if (!strcmp(result.note, fixed_result.note) &&
+						   fabs(result.reference_freq - fixed_result.reference_freq) < 0.01 &&
+						   result.adjust == fixed_result.adjust)
+				{
+					continue;
+				}
+
+				differ++;
+				if (fabs(tuner->max / TUNER_POWER_MIN - 1.0) <= READING_NOISE_MARGIN ||
+					(result.note != NULL && fixed_result.note != NULL &&
+					 fabs(result.actual_freq - fixed_result.actual_freq) < 1.5 * bin))
+				{
+					(*allowed)++;
+					continue;
+				}
+
+				fprintf(stderr, "%8.3f Hz (amplitude %.0f): float %s %.2f Hz, fixed %s %.2f Hz\n",
+						freq, READING_AMPLITUDES[j],
+						result.note ? result.note : "-", result.actual_freq,
+						fixed_result.note ? fixed_result.note : "-", fixed_result.actual_freq);
+			}
+		}
+	}
+
+	return(differ);
+}
+
+/* Partials n * f0 * sqrt(1 + B * n^2), Amplitude 1/n, 16 Bit */
+static void bench_intonation_signal (double f0, double b, unsigned int seed) {
+	double v, fn;
+	unsigned int i, n;
+
+	for (i=0; i < TUNER_INTONATION_NSAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		v = (double) ((seed >> 16) % 257) - 128.0;
+		for (n=1; n <= TUNER_MAX_PARTIALS; n++) {
+			fn = n * f0 * sqrt(1.0 + b * n * n);
+			v += 12000.0 / n * sin(2.0 * M_PI * fn * i / BENCH_SAMPLING_FREQ);
+		}
+		intonation_samples[i] = (short) floor(v + 0.5);
+	}
+}
+
+/* Intonation Mode Accuracy, Returns the Failed Strings */
+static unsigned int bench_intonation_accuracy (double *max_cents, double *max_b) {
+	GuitarTunerIntonation *intonation;
+	GuitarTunerIntonationResult result;
+	unsigned int failed = 0;
+	unsigned int i, j;
+	double f1, b, cents, b_error;
+
+	*max_cents = 0.0;
+	*max_b = 0.0;
+	for (i=0; i < sizeof(INTONATION_NOTES) / sizeof(INTONATION_NOTES[0]); i++) {
+		for (j=0; j < sizeof(INTONATION_B) / sizeof(INTONATION_B[0]); j++) {
+			b = INTONATION_B[j];
+
+			/* New Context, one Window (no Inharmonicity Predicted) */
+			intonation = tuner_intonation_new(BENCH_SAMPLING_FREQ, 0,
+											  TUNER_INTONATION_NSAMPLES, 0);
+			if (intonation == NULL)
+				return(1);
+
+			bench_intonation_signal(INTONATION_NOTES[i], b, i * 4 + j);
+			if (tuner_intonation_process(intonation, intonation_samples, 
+										 TUNER_INTONATION_NSAMPLES, 
+										 TUNER_FORMAT_S16, &result) <= 0 ||
+				result.note == NULL)
+			{
+				fprintf(stderr, "%8.3f Hz B = %.0e: no note\n", INTONATION_NOTES[i], b);
+				tuner_intonation_free(intonation);
+				failed++;
+				continue;
+			}
+
+			/* The first Partial is f0 * sqrt(1 + B) */
+			f1 = INTONATION_NOTES[i] * sqrt(1.0 + b);
+			cents = fabs(1200.0 * log(result.fundamental / f1) / log(2.0));
+			b_error = fabs(result.inharmonicity - b);
+			if (cents > *max_cents) *max_cents = cents;
+			if (b_error > *max_b) *max_b = b_error;
+
+			if (cents > INTONATION_MAX_CENTS ||
+				b_error > INTONATION_MAX_B_ERROR * b + INTONATION_MIN_B)
+			{
+				fprintf(stderr, "%8.3f Hz B = %.0e: %.3f Hz (%.2f cents), B = %.2e\n",
+						INTONATION_NOTES[i], b, result.fundamental, cents, 
+						result.inharmonicity);
+				failed++;
+			}
+
+			tuner_intonation_free(intonation);
+		}
+	}
+
+	return(failed);
+}
+
+/* Intonation Mode, ms per Window */
+static double bench_intonation (unsigned int frames, int nthreads) {
+	GuitarTunerIntonation *intonation;
+	GuitarTunerIntonationResult result;
+	struct timeval start;
+	double ms;
+	unsigned int i;
+
+	/* One Window every NSAMPLES pushed */
+	intonation = tuner_intonation_new(BENCH_SAMPLING_FREQ, TUNER_INTONATION_NSAMPLES,
+									  NSAMPLES, nthreads);
+	if (intonation == NULL)
+		return(0.0);
+
+	gettimeofday(&start, NULL);
+	for (i=0; i < frames; i++)
+		tuner_intonation_process(intonation, samples, NSAMPLES, TUNER_FORMAT_U8, &result);
+	ms = bench_elapsed(&start) / frames;
+
+	tuner_intonation_free(intonation);
+	return(ms);
+}
+
+int main (int argc, char **argv) {
+	unsigned int frames = 20;
+	unsigned int mismatch = 0;
+	unsigned int chunks_failed = 0;
+	unsigned int readings, readings_differ, readings_allowed;
+	GuitarTuner *fixed_tuner;
+	unsigned int intonation_failed;
+	double intonation_cents, intonation_b;
+	unsigned int failed = 0;
+	unsigned int tested = 0;
+	double max_cents = 0.0;
+	double freq, cents;
+	unsigned int index;
+	struct timeval start;
+	double float_ms, fixed_ms;
+	double intonation_ms, intonation_mt_ms;
+	long ncpus;
+	long long power;
+	unsigned int i;
+	int note;
+
+	if (argc > 1)
+		frames = (unsigned int) atoi(argv[1]);
+	if (frames == 0)
+		frames = 1;
+
+	/* Threaded FFTW Plans, before any other FFTW Call */
+	tuner_intonation_init_threads();
+
+	if ((tuner = tuner_new(BENCH_SAMPLING_FREQ)) == NULL)
+		return(1);
+
+	/* Accuracy: Same Peak Bin? */
+	for (note=BENCH_NOTE_FIRST; note <= BENCH_NOTE_LAST; note++) {
+		freq = 440.0 * pow(2.0, (note * 100.0 + BENCH_DETUNE_CENTS) / 1200.0);
+		bench_signal(freq, 60.0, (unsigned int) tested);
+
+		tuner_process(tuner, samples, NSAMPLES, TUNER_FORMAT_U8, &result);
+		index = bench_fixed_peak(&power);
+		tested++;
+
+		if (index != tuner->max_index) {
+			cents = fabs(1200.0 * log((double) index / tuner->max_index) / log(2.0));
+			if (cents > max_cents) max_cents = cents;
+			mismatch++;
+
+			if (index > tuner->max_index + 1 || index + 1 < tuner->max_index)
+				failed++;
+
+			fprintf(stderr, "%8.3f Hz: float bin %u, fixed bin %u (%.2f cents)\n",
+					freq, tuner->max_index, index, cents);
+		}
+
+		/* Same Frame, Pushed in Chunks */
+		index = tuner->max_index;
+		if ((i = bench_chunks(index)) > 0) {
+			fprintf(stderr, "%8.3f Hz: chunked push missed bin %u (%u frames)\n",
+					freq, index, i);
+			chunks_failed += i;
+		}
+	}
+
+	/* Float vs Fixed Readings (tuner_process() of both Builds) */
+	if ((fixed_tuner = bench_fixed_tuner_new(BENCH_SAMPLING_FREQ)) == NULL)
+		return(1);
+	readings_differ = bench_readings(fixed_tuner, &readings, &readings_allowed);
+	bench_fixed_tuner_free(fixed_tuner);
+
+	/* Intonation Mode: Cents and Inharmonicity */
+	intonation_failed = bench_intonation_accuracy(&intonation_cents, &intonation_b);
+
+	/* Speed */
+	bench_signal(440.0, 60.0, 0);
+
+	gettimeofday(&start, NULL);
+	for (i=0; i < frames; i++)
+		tuner_process(tuner, samples, NSAMPLES, TUNER_FORMAT_U8, &result);
+	float_ms = bench_elapsed(&start) / frames;
+
+	gettimeofday(&start, NULL);
+	for (i=0; i < frames; i++)
+		bench_fixed_peak(&power);
+	fixed_ms = bench_elapsed(&start) / frames;
+
+	ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	intonation_ms = bench_intonation(frames, 1);
+	intonation_mt_ms = bench_intonation(frames, 0);
+
+	printf("Notes Tested:      %u (detuned %+.1f cents)\n", tested, BENCH_DETUNE_CENTS);
+	printf("Peak Mismatches:   %u\n", mismatch);
+	printf("Max Difference:    %.2f cents\n", max_cents);
+	printf("Chunked Mismatch:  %u frames\n", chunks_failed);
+	printf("Fixed Readings:    %u differ of %u (%u tolerated)\n",
+		   readings_differ, readings, readings_allowed);
+	printf("Intonation Error:  %.2f cents, B %.1e (%u failed)\n",
+		   intonation_cents, intonation_b, intonation_failed);
+	printf("Float (FFTW):      %.3f ms/frame\n", float_ms);
+	printf("Fixed (Q15):       %.3f ms/frame\n", fixed_ms);
+	printf("Intonation %u:  %.3f ms/window (1 thread)\n", 
+		   TUNER_INTONATION_NSAMPLES, intonation_ms);
+	printf("Intonation %u:  %.3f ms/window (%ld CPUs)\n", 
+		   TUNER_INTONATION_NSAMPLES, intonation_mt_ms, ncpus);
+
+	tuner_free(tuner);
+	return(failed > 0 || chunks_failed > 0 || intonation_failed > 0 ||
+		   readings_differ > readings_allowed);
+}
@@ -0,0 +1,31 @@
+/* [ bench_fixed.c ] - Guitar Tuner Fixed-Point Tuner for the Benchmark
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* tuner.c built with TUNER_FIXED_POINT next to the FFTW one, in the
+ * same binary: the public names get the bench_fixed_ prefix. It's what
+ * --enable-fixed-point ships, noise threshold and Q16.16 notes included.
+ */
+#define TUNER_FIXED_POINT
+
+#define tuner_new		bench_fixed_tuner_new
+#define tuner_free		bench_fixed_tuner_free
+#define tuner_process	bench_fixed_tuner_process
+
+#include "tuner.c"
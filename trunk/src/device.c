@@ -0,0 +1,159 @@
+/* [ device.c ] - Guitar Tuner Sound Device
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* Standard Headers */
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/soundcard.h>
+
+#include "device.h"
+
+const char *DEFAULT_DEVICE_AUDIO = "/dev/dsp";
+
+int tuner_sound_device_init (GuitarTunerDevice *device, const char *name,
+							 GuitarTunerFormat format)
+{
+	if (name == NULL)
+		name = DEFAULT_DEVICE_AUDIO;
+
+	device->channels = 0;
+	device->format = (format == TUNER_FORMAT_S16) ? AFMT_S16_NE : AFMT_U8;
+	device->sampling_frequency = 22050;
+
+	/* Open Sound Device */
+	if ((device->fd = open(name, O_RDONLY)) < 0) {
+		perror("open()");
+		return(-1);
+	}
+
+	/* Channels Setting */
+	if (ioctl(device->fd, SNDCTL_DSP_CHANNELS, &device->channels) < 0) {
+		perror("Channels Setting - ioctl()");
+		goto snd_dev_err_close;
+	}
+
+	/* Sound Format */
+	if (ioctl(device->fd, SNDCTL_DSP_SETFMT, &device->format) < 0) {
+		perror("Sound Format - ioctl()");
+		goto snd_dev_err_close;
+	}
+
+	/* Sampling Rate */
+	if (ioctl(device->fd, SNDCTL_DSP_SPEED, &device->sampling_frequency) < 0) {
+		perror("Sampling Rate - ioctl()");
+		goto snd_dev_err_close;
+	}
+
+	/* The Device may not Support 16bit and Fall back to 8bit */
+	if (device->format == AFMT_S16_NE) {
+		device->tuner_format = TUNER_FORMAT_S16;
+	} else if (device->format == AFMT_U8) {
+		device->tuner_format = TUNER_FORMAT_U8;
+	} else {
+		fprintf(stderr, "Sound Format %d is not Supported\n", device->format);
+		goto snd_dev_err_close;
+	}
+
+	/* All Seems OK, Return Device Descriptor */
+	return(device->fd);
+
+	/* Error: Close Snd Device and Return Error */
+snd_dev_err_close:
+	close(device->fd);
+	device->fd = -1;
+	return(-1);
+}
+
+/* Read up to DEVICE_NSAMPLES Samples, Returns how many */
+int tuner_sound_device_read_samples (GuitarTunerDevice *device, void *samples) {
+	unsigned char *buffer = (unsigned char *) samples;
+	size_t sample_size = sizeof(unsigned char);
+	size_t size = 0;
+	ssize_t ret;
+
+	if (device->tuner_format == TUNER_FORMAT_S16)
+		sample_size = sizeof(short);
+
+	/* Read Device Data, until there are only Whole Samples */
+	do {
+		ret = read(device->fd, buffer + size, DEVICE_NSAMPLES * sample_size - size);
+		if (ret < 0) {
+			/* Interrupted by a Signal, just Retry */
+			if (errno == EINTR)
+				continue;
+
+			perror("read()");
+			return(-1);
+		} else if (ret == 0) {
+			/* End of File, Nothing more to Push */
+			return(-1);
+		}
+
+		size += ret;
+	} while (size == 0 || size % sample_size != 0);
+
+	return((int) (size / sample_size));
+}
+
+/* Read from Device and Push to the Tuner until a Frame is Analyzed */
+int tuner_sound_device_read (GuitarTunerDevice *device, 
+							 GuitarTuner *tuner,
+							 GuitarTunerResult *result)
+{
+	short input[DEVICE_NSAMPLES];
+	int n, ret;
+
+	do {
+		if ((n = tuner_sound_device_read_samples(device, input)) < 0)
+			return(-1);
+
+		ret = tuner_process(tuner, input, n, device->tuner_format, result);
+	} while (ret == 0);
+
+	return(ret);
+}
+
+/* Same as tuner_sound_device_read(), for the Intonation Mode */
+int tuner_sound_device_read_intonation (GuitarTunerDevice *device,
+										GuitarTunerIntonation *intonation,
+										GuitarTunerIntonationResult *result)
+{
+	short input[DEVICE_NSAMPLES];
+	int n, ret;
+
+	do {
+		if ((n = tuner_sound_device_read_samples(device, input)) < 0)
+			return(-1);
+
+		ret = tuner_intonation_process(intonation, input, n, 
+									   device->tuner_format, result);
+	} while (ret == 0);
+
+	return(ret);
+}
@@ -0,0 +1,59 @@
+/* [ device.h ] - Guitar Tuner Sound Device
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GUITAR_TUNER_DEVICE_H__
+#define __GUITAR_TUNER_DEVICE_H__
+
+#include "guitartuner.h"
+
+/* Samples Read (and Pushed to the Tuner) at once */
+#define DEVICE_NSAMPLES		(1024)
+
+typedef struct _guitar_tuner_device {
+	/* Device Descriptor */
+	int fd;
+
+	/* Channels: (Mono = 0, Stereo = 1) */
+	int channels;
+
+	/* AFMT_U8 is the 8bit Format (128 is Silence), Read as Unsigned Char.
+	 * AFMT_S16_NE (16bit) Samples are Read as Short.
+	 * Any other Format the Driver Answers with is Refused.
+	 */
+	int format;
+
+	/* Sampling Rate, the Device may change it when opened */
+	int sampling_frequency;
+
+	/* Format of the Samples Pushed to the Tuner */
+	GuitarTunerFormat tuner_format;
+} GuitarTunerDevice;
+
+int tuner_sound_device_init (GuitarTunerDevice *device, const char *name,
+							 GuitarTunerFormat format);
+int tuner_sound_device_read_samples (GuitarTunerDevice *device, void *samples);
+int tuner_sound_device_read (GuitarTunerDevice *device, 
+							 GuitarTuner *tuner,
+							 GuitarTunerResult *result);
+int tuner_sound_device_read_intonation (GuitarTunerDevice *device,
+										GuitarTunerIntonation *intonation,
+										GuitarTunerIntonationResult *result);
+
+#endif /* !__GUITAR_TUNER_DEVICE_H__ */
@@ -0,0 +1,134 @@
+/* [ fixed.c ] - Guitar Tuner Fixed-Point DSP
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "fixed.h"
+
+/* Q15 Multiply: b is at most Q22 so the product needs 64 bit */
+#define FIXED_MUL(a, b)		((int) (((long long) (a) * (b)) >> 15))
+
+/* sin(2PI * i / n) = cos(2PI * (i - n/4) / n) */
+#define FIXED_SIN(cosine, i, n)	((cosine)[((i) + 3 * ((n) >> 2)) & ((n) - 1)])
+
+/* 8 Bit Samples: (input - 128) is the same value the double path uses,
+ * times the Q15 window gives a Q15 number with 8 bit of integer part.
+ */
+void fixed_load_u8 (int *data, const unsigned char *input,
+					const short *window, unsigned int count)
+{
+	unsigned int i;
+
+	for (i=0; i < count; i++)
+		data[i] = ((int) input[i] - 128) * window[i];
+}
+
+/* 16 Bit Samples: scaled down by 256 to match the 8 Bit amplitude */
+void fixed_load_s16 (int *data, const short *input,
+					 const short *window, unsigned int count)
+{
+	unsigned int i;
+
+	for (i=0; i < count; i++)
+		data[i] = ((int) input[i] * window[i]) >> 8;
+}
+
+/* Radix-2 Decimation in Time, every stage is halved to avoid overflow.
+ * The cosine table has n entries, the transform has n/2 points.
+ */
+void fixed_fft (int *data, const short *cosine, unsigned int n) {
+	unsigned int m = n >> 1;
+	unsigned int i, j, k, len, half, step;
+	int tr, ti, wr, wi;
+
+	/* Bit Reversal */
+	for (i=1, j=0; i < m; i++) {
+		for (k = m >> 1; j & k; k >>= 1)
+			j ^= k;
+		j |= k;
+
+		if (i < j) {
+			tr = data[2*i]; data[2*i] = data[2*j]; data[2*j] = tr;
+			ti = data[2*i+1]; data[2*i+1] = data[2*j+1]; data[2*j+1] = ti;
+		}
+	}
+
+	/* Butterflies: (a, b) -> ((a + b*w) / 2, (a - b*w) / 2) */
+	for (len=2; len <= m; len <<= 1) {
+		half = len >> 1;
+		step = n / len;
+
+		for (j=0; j < half; j++) {
+			/* w = e^(-2PI i j / len) = wr - i wi */
+			wr = cosine[j * step];
+			wi = FIXED_SIN(cosine, j * step, n);
+
+			for (i=j; i < m; i += len) {
+				int *a = data + 2*i;
+				int *b = data + 2*(i + half);
+
+				tr = FIXED_MUL(b[0], wr) + FIXED_MUL(b[1], wi);
+				ti = FIXED_MUL(b[1], wr) - FIXED_MUL(b[0], wi);
+
+				b[0] = (a[0] - tr) >> 1;
+				b[1] = (a[1] - ti) >> 1;
+				a[0] = (a[0] + tr) >> 1;
+				a[1] = (a[1] + ti) >> 1;
+			}
+		}
+	}
+}
+
+/* Split the Packed Spectrum Z into the Real Spectrum X, only for the
+ * requested bins (from >= 1, to <= n/2):
+ *     X[k] = (Z[k] + Z*[m-k]) / 2 + W^k (Z[k] - Z*[m-k]) / 2i
+ * The two /2 are left out, that's why the power is scaled.
+ */
+unsigned int fixed_peak (const int *data, const short *cosine,
+						 unsigned int n, unsigned int from, unsigned int to,
+						 long long *max)
+{
+	unsigned int m = n >> 1;
+	unsigned int max_index = 0;
+	int er, ei, odr, odi, xr, xi;
+	const int *z, *zm;
+	unsigned int k;
+	long long tmp;
+
+	*max = 0;
+	for (k=from; k < to; k++) {
+		z = data + 2*k;
+		zm = data + 2*(m - k);
+
+		er = z[0] + zm[0];
+		ei = z[1] - zm[1];
+		odr = z[1] + zm[1];
+		odi = zm[0] - z[0];
+
+		xr = er + FIXED_MUL(odr, cosine[k]) + FIXED_MUL(odi, FIXED_SIN(cosine, k, n));
+		xi = ei + FIXED_MUL(odi, cosine[k]) - FIXED_MUL(odr, FIXED_SIN(cosine, k, n));
+
+		tmp = (long long) xr * xr + (long long) xi * xi;
+		if (tmp > *max) {
+			*max = tmp;
+			max_index = k;
+		}
+	}
+
+	return(max_index);
+}
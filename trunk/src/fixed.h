@@ -0,0 +1,54 @@
+/* [ fixed.h ] - Guitar Tuner Fixed-Point DSP
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GUITAR_TUNER_FIXED_H__
+#define __GUITAR_TUNER_FIXED_H__
+
+/* Integer Only DSP for Boards without FPU.
+ *
+ * Tables are Q15 (32767 = 1.0). Samples are windowed into Q22 and the
+ * N points real FFT is done as an N/2 points complex FFT that halves
+ * at every stage, so everything fits in 32 bit words and the only wide
+ * operation is the 32x16 -> 64 bit multiply of the butterflies.
+ *
+ * The FFT works on data[n]: the real samples seen as n/2 interleaved
+ * complex (Even = Real, Odd = Imaginary), so the samples can be loaded
+ * a few at a time at their position in the frame.
+ *
+ * The power returned by fixed_peak() is 64 times the power computed
+ * by the FFTW (double) path on the same samples.
+ */
+#define FIXED_POWER_SCALE		(64)
+
+/* Window count Samples into data, window and data at the same offset */
+void fixed_load_u8 (int *data, const unsigned char *input,
+					const short *window, unsigned int count);
+void fixed_load_s16 (int *data, const short *input,
+					 const short *window, unsigned int count);
+
+/* In-Place n/2 points Complex FFT of the n Real Samples */
+void fixed_fft (int *data, const short *cosine, unsigned int n);
+
+/* Search the Highest Power Bin in [from, to) of the n points Real Spectrum */
+unsigned int fixed_peak (const int *data, const short *cosine,
+						 unsigned int n, unsigned int from, unsigned int to,
+						 long long *max);
+
+#endif /* !__GUITAR_TUNER_FIXED_H__ */
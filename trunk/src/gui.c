@@ -18,18 +18,90 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+
 #include <gtk/gtk.h>
 #include <glib.h>
 #include "gui.h"
 
+/* Same Order as GuitarTunerPixmap */
+static const char *PIXMAP_FILES[GUI_NPIXMAPS] = {
+	"Skin.png", "Icon.png", "Empty.png", "Sharp.png", "NoSharp.png",
+	"Up.png", "Down.png",
+	"A.png", "B.png", "C.png", "D.png", "E.png", "F.png", "G.png"
+};
+
 static void on_destroy	(GtkWidget *widget, gpointer data);
 static void on_about	(GtkWidget *widget, gpointer data);
+static gboolean on_map	(GtkWidget *widget, GdkEvent *event, gpointer data);
+static gboolean on_pixmaps_loaded	(gpointer data);
+static gpointer guitar_tuner_gui_pixmaps_load	(gpointer data);
 static void guitar_tuner_gui_menu_init	(GuitarTunerGUI *gui);
 
 static void on_destroy (GtkWidget *widget, gpointer data) {
 	gtk_main_quit();
 }
 
+/* Window is on Screen: Decode the Pixmaps without Blocking the Main Loop */
+static gboolean on_map (GtkWidget *widget, GdkEvent *event, gpointer data) {
+	g_signal_handlers_disconnect_by_func(G_OBJECT(widget), 
+										 G_CALLBACK(on_map), data);
+
+	if (g_thread_create(guitar_tuner_gui_pixmaps_load, data, FALSE, NULL) == NULL)
+		guitar_tuner_gui_pixmaps_load(data);
+
+	return(FALSE);
+}
+
+/* Pixmaps Loader Thread, the GUI is Updated from the Main Loop */
+static gpointer guitar_tuner_gui_pixmaps_load (gpointer data) {
+	GuitarTunerGUI *gui = (GuitarTunerGUI *) data;
+	char path[256];
+	unsigned int i;
+
+	for (i=0; i < GUI_NPIXMAPS; i++) {
+		snprintf(path, 256, "%s/%s", PIXMAPS_DIR, PIXMAP_FILES[i]);
+		gui->pixmaps_loading[i] = gdk_pixbuf_new_from_file(path, NULL);
+	}
+
+	g_idle_add(on_pixmaps_loaded, gui);
+	return(NULL);
+}
+
+static gboolean on_pixmaps_loaded (gpointer data) {
+	GuitarTunerGUI *gui = (GuitarTunerGUI *) data;
+	unsigned int i;
+
+	/* get GDK thread lock */
+	gdk_threads_enter();
+
+	for (i=0; i < GUI_NPIXMAPS; i++)
+		gui->pixmaps[i] = gui->pixmaps_loading[i];
+
+	/* Set Window Icon and Skin */
+	gtk_window_set_default_icon(gui->pixmaps[GUI_PIXMAP_ICON]);
+	gtk_window_set_icon(GTK_WINDOW(gui->window), gui->pixmaps[GUI_PIXMAP_ICON]);
+	gtk_image_set_from_pixbuf(GTK_IMAGE(gui->image_skin), 
+							  gui->pixmaps[GUI_PIXMAP_SKIN]);
+
+	/* What the Tuner Thread has Shown so far */
+	guitar_tuner_gui_set_image(gui, gui->image_note, 
+							   &(gui->image_note_pixmap), gui->image_note_pixmap);
+	guitar_tuner_gui_set_image(gui, gui->image_sharp, 
+							   &(gui->image_sharp_pixmap), gui->image_sharp_pixmap);
+	guitar_tuner_gui_set_image(gui, gui->image_adjustament, 
+							   &(gui->image_adjustament_pixmap), 
+							   gui->image_adjustament_pixmap);
+
+	/* release GDK thread lock */
+	gdk_threads_leave();
+	return(FALSE);
+}
+
 static void on_about (GtkWidget *widget, gpointer data) {
 	GdkPixbuf *pixbuf_logo;
 	GtkWidget *dialog;
@@ -99,8 +171,31 @@ static void guitar_tuner_gui_menu_init (GuitarTunerGUI *gui) {
 	gtk_menu_bar_append(GTK_MENU_BAR(gui->menubar), root_menu);
 }
 
+void guitar_tuner_gui_set_image (GuitarTunerGUI *gui, GtkWidget *image,
+								 GuitarTunerPixmap *shown,
+								 GuitarTunerPixmap pixmap)
+{
+	*shown = pixmap;
+
+	if (pixmap < GUI_NPIXMAPS)
+		gtk_image_set_from_pixbuf(GTK_IMAGE(image), gui->pixmaps[pixmap]);
+	else
+		gtk_image_set_from_pixbuf(GTK_IMAGE(image), NULL);
+}
+
 void guitar_tuner_gui_init (GuitarTunerGUI *gui) {
-	GdkPixbuf *win_icon;
+	unsigned int i;
+
+	/* Pixmaps are Loaded once the Window is Mapped */
+	for (i=0; i < GUI_NPIXMAPS; i++) {
+		gui->pixmaps[i] = NULL;
+		gui->pixmaps_loading[i] = NULL;
+	}
+
+	/* No Note until the first Reading */
+	gui->image_note_pixmap = GUI_PIXMAP_EMPTY;
+	gui->image_sharp_pixmap = GUI_PIXMAP_NOSHARP;
+	gui->image_adjustament_pixmap = GUI_NPIXMAPS;
 
 	/* Init Guitar Tuner Window */
 	gui->window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
@@ -111,27 +206,26 @@ void guitar_tuner_gui_init (GuitarTunerGUI *gui) {
 	/* Window Events */
 	g_signal_connect(G_OBJECT(gui->window), "destroy",
 					 G_CALLBACK(on_destroy), NULL);
-
-	/* Set Window Icon */
-	win_icon = gdk_pixbuf_new_from_file(PIXMAPS_DIR "/Icon.png", NULL);
-	gtk_window_set_default_icon(win_icon);
+	g_signal_connect(G_OBJECT(gui->window), "map-event",
+					 G_CALLBACK(on_map), gui);
 
 	/* Init Guitar Tuner FixedBox */
 	gui->fixedbox = gtk_fixed_new();
 	gtk_container_add(GTK_CONTAINER(gui->window), gui->fixedbox);
 
 	/* Set Window Skin (Window Background) */
-	gui->image_skin = gtk_image_new_from_file(PIXMAPS_DIR "/Skin.png");
+	gui->image_skin = gtk_image_new();
+	gtk_widget_set_size_request(gui->image_skin, 400, 250);
 	gtk_fixed_put(GTK_FIXED(gui->fixedbox), gui->image_skin, 0, 20);
 
 	/* Setup Image Note */
-	gui->image_note = gtk_image_new_from_file(PIXMAPS_DIR "/Empty.png");
+	gui->image_note = gtk_image_new();
 	/* gui->image_note = gtk_image_new_from_file("Pixmap/A.png"); */
 	gtk_widget_set_size_request(gui->image_note, 100, 100);
 	gtk_fixed_put(GTK_FIXED(gui->fixedbox), gui->image_note, 40, 45);
 
 	/* Setup Image Sharp */
-	gui->image_sharp = gtk_image_new_from_file(PIXMAPS_DIR "/NoSharp.png");
+	gui->image_sharp = gtk_image_new();
 	/* gui->image_sharp = gtk_image_new_from_file("Pixmap/Sharp.png"); */
 	gtk_widget_set_size_request(gui->image_sharp, 70, 100);
 	gtk_fixed_put(GTK_FIXED(gui->fixedbox), gui->image_sharp, 140, 55);
@@ -152,6 +246,11 @@ void guitar_tuner_gui_init (GuitarTunerGUI *gui) {
 	gtk_widget_set_size_request(gui->image_adjustament, 29, 21);
 	gtk_fixed_put(GTK_FIXED(gui->fixedbox), gui->image_adjustament, 280, 75);
 
+	/* Setup Label Status (Connecting, Errors, Intonation Mode) */
+	gui->label_status = gtk_label_new("");
+	gtk_label_set_use_markup(GTK_LABEL(gui->label_status), TRUE);
+	gtk_fixed_put(GTK_FIXED(gui->fixedbox), gui->label_status, 40, 152);
+
 	/* Init Menu BAR */
 	guitar_tuner_gui_menu_init(gui);
 
@@ -23,11 +23,28 @@
 
 #include <gtk/gtk.h>
 #include <glib.h>
-#include "tuner.h"
+#include "guitartuner.h"
+#include "device.h"
 
 #define GUITAR_TUNER_NAME	"Guitar Tuner"
 #define GUITAR_TUNER_VERSION	"0.1.2"
 
+/* Pixmaps, see PIXMAP_FILES in gui.c */
+typedef enum _gui_pixmap {
+	GUI_PIXMAP_SKIN,
+	GUI_PIXMAP_ICON,
+	GUI_PIXMAP_EMPTY,
+	GUI_PIXMAP_SHARP,
+	GUI_PIXMAP_NOSHARP,
+	GUI_PIXMAP_UP,
+	GUI_PIXMAP_DOWN,
+	GUI_PIXMAP_NOTE_A,	/* A..G are in order */
+	GUI_PIXMAP_NOTE_G = GUI_PIXMAP_NOTE_A + 6,
+	GUI_NPIXMAPS
+} GuitarTunerPixmap;
+
+#define GUI_PIXMAP_NOTE(label)	(GUI_PIXMAP_NOTE_A + ((label) - 'A'))
+
 typedef struct _guitar_tuner_gui {
 	/* Base Window */
 	GtkWidget *image_skin;
@@ -48,9 +65,39 @@ typedef struct _guitar_tuner_gui {
 	/* Adjustament */
 	GtkWidget *image_adjustament;
 
-	GuitarTuner tuner;
+	/* Status: Connecting, Device Error,
+	 * Intonation Mode: Cents, Inharmonicity
+	 */
+	GtkWidget *label_status;
+
+	/* Pixmaps are Decoded by a Thread once the Window is Mapped,
+	 * they're NULL until then (Use them with the GDK lock held).
+	 */
+	GdkPixbuf *pixmaps[GUI_NPIXMAPS];
+	GdkPixbuf *pixmaps_loading[GUI_NPIXMAPS];
+
+	/* Pixmap Shown by each Image (GUI_NPIXMAPS for None), Set again
+	 * when the Pixmaps are Loaded: a Reading may come before them.
+	 */
+	GuitarTunerPixmap image_note_pixmap;
+	GuitarTunerPixmap image_sharp_pixmap;
+	GuitarTunerPixmap image_adjustament_pixmap;
+
+	/* Sound Device, Opened by the Tuner Thread
+	 * (16bit Samples in Intonation Mode, 8bit otherwise)
+	 */
+	int intonation_mode;
+	const char *device_name;
+	GuitarTunerDevice device;
+	GuitarTuner *tuner;
+	GuitarTunerIntonation *intonation;
 } GuitarTunerGUI;
 
 void guitar_tuner_gui_init (GuitarTunerGUI *gui);
 
+/* Show pixmap in image and Remember it in shown, with the GDK lock held */
+void guitar_tuner_gui_set_image (GuitarTunerGUI *gui, GtkWidget *image,
+								 GuitarTunerPixmap *shown,
+								 GuitarTunerPixmap pixmap);
+
 #endif /* !__GUITAR_TUNER_GUI_H__ */
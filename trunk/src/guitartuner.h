@@ -0,0 +1,144 @@
+/* [ guitartuner.h ] - Guitar Tuner Library
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GUITAR_TUNER_LIB_H__
+#define __GUITAR_TUNER_LIB_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* libguitartuner: Note Detection without any I/O.
+ * The caller owns the audio and pushes it with tuner_process(), from
+ * its own audio callback if it likes. Samples are windowed straight
+ * from the caller's buffer into the FFT input, nothing is copied.
+ *
+ *     GuitarTuner *tuner = tuner_new(44100);
+ *     ...
+ *     if (tuner_process(tuner, buf, n, TUNER_FORMAT_S16, &result) > 0)
+ *         if (result.note != NULL) ...
+ *     ...
+ *     tuner_free(tuner);
+ *
+ * Every GuitarTuner is independent, tuner_process() can run on many
+ * contexts at the same time. tuner_new(), tuner_free() and all the
+ * tuner_intonation_*() but tuner_intonation_process() use the FFTW
+ * planner (and a flag of the library) that are not thread safe: don't
+ * call them concurrently, nor with the host's own FFTW planning.
+ */
+
+/* Opaque Tuner Context */
+typedef struct _guitar_tuner GuitarTuner;
+
+/* Samples Format (Mono) */
+typedef enum _tuner_format {
+	TUNER_FORMAT_U8,	/* 8bit, 128 is Silence */
+	TUNER_FORMAT_S16	/* 16bit Signed, Native Endian */
+} GuitarTunerFormat;
+
+typedef enum _tuner_adjust {
+	TUNER_ADJUST_NONE,
+	TUNER_ADJUST_DOWN,
+	TUNER_ADJUST_UP
+} GuitarTunerAdjust;
+
+typedef struct _tuner_result {
+	/* Frequence & Adjustament, note is NULL when there's only Noise */
+	double reference_freq;
+	double actual_freq;
+	const char *note;
+	GuitarTunerAdjust adjust;
+} GuitarTunerResult;
+
+GuitarTuner *tuner_new (int sampling_frequency);
+void tuner_free (GuitarTuner *tuner);
+
+/* Push n Samples. Returns 1 when a frame was analyzed and result
+ * is updated, 0 when more samples are needed, -1 on invalid arguments.
+ */
+int tuner_process (GuitarTuner *tuner,
+				   const void *samples, size_t n,
+				   GuitarTunerFormat format,
+				   GuitarTunerResult *result);
+
+/* Intonation Mode: Long Overlapping Windows (65536+ Samples) analyzed
+ * with multi-threaded FFTW plans every hop Samples. The fundamental is
+ * interpolated between bins and the partials are tracked to measure
+ * the inharmonicity B:  f(n) = n * f0 * sqrt(1 + B * n^2)
+ * Not available with --enable-fixed-point (tuner_intonation_new() fails).
+ */
+#define TUNER_INTONATION_NSAMPLES	(65536)
+#define TUNER_MAX_PARTIALS			(8)
+
+typedef struct _guitar_tuner_intonation GuitarTunerIntonation;
+
+typedef struct _tuner_intonation_result {
+	/* Fundamental and Nearest Equal Tempered Note (A4 = 440Hz),
+	 * note is NULL when there's only Noise.
+	 */
+	double fundamental;
+	double reference_freq;
+	double cents;
+	const char *note;
+	int octave;
+
+	/* partials[n - 1] is the n-th Partial (0.0 if not Found),
+	 * partials_cents[n - 1] its distance from n * fundamental.
+	 */
+	unsigned int npartials;
+	double partials[TUNER_MAX_PARTIALS];
+	double partials_cents[TUNER_MAX_PARTIALS];
+	double inharmonicity;
+} GuitarTunerIntonationResult;
+
+/* Threaded Plans are Optional, the library doesn't touch the FFTW
+ * threads unless asked: call this once, before any other FFTW call of
+ * the process (tuner_new() included), if the host didn't call
+ * fftw_init_threads() itself. Returns 1 if threaded plans are
+ * available, 0 otherwise (no libfftw3_threads, --enable-fixed-point).
+ */
+int tuner_intonation_init_threads (void);
+
+/* nsamples: Window Size (0 for TUNER_INTONATION_NSAMPLES, at least 16384)
+ * hop: Samples between two Windows (0 for sampling_frequency / 4)
+ * nthreads: FFTW Threads (0 for the Online CPUs), used only after
+ *     tuner_intonation_init_threads(). The planner threads are set to
+ *     nthreads for this plan and then back to the host's count (FFTW
+ *     3.3.9+, older FFTW can't tell it: back to 1).
+ */
+GuitarTunerIntonation *tuner_intonation_new (int sampling_frequency,
+											 unsigned int nsamples,
+											 unsigned int hop,
+											 int nthreads);
+void tuner_intonation_free (GuitarTunerIntonation *intonation);
+
+/* Same as tuner_process(), 1 when a Window was analyzed */
+int tuner_intonation_process (GuitarTunerIntonation *intonation,
+							  const void *samples, size_t n,
+							  GuitarTunerFormat format,
+							  GuitarTunerIntonationResult *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !__GUITAR_TUNER_LIB_H__ */
@@ -0,0 +1,452 @@
+/* [ intonation.c ] - Guitar Tuner Intonation Mode
+ * Author: Matteo Bertozzi
+ * ============================================================================
+ * This file is part of Guitar Tuner.
+ *
+ * Guitar Tuner is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Guitar Tuner is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* Standard Headers */
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "tuner.h"
+
+#ifndef TUNER_FIXED_POINT
+
+/* Fundamental Search Range (Piano A0 is 27.5Hz, C8 is 4186Hz) */
+#define INTONATION_MIN_FREQ		(25.0)
+#define INTONATION_MAX_FREQ		(4500.0)
+
+/* The Strongest Peak may be the h-th Partial, up to this h */
+#define INTONATION_MAX_SUBHARMONIC	(4)
+
+/* Peaks Power, relative to the Strongest Peak */
+#define INTONATION_SUBHARMONIC_MIN	(1e-3)	/* -30dB */
+#define INTONATION_PARTIAL_MIN		(1e-4)	/* -40dB */
+
+/* Same Noise Level of the Note Detection (16384 Samples),
+ * the Power of a Sine grows with the square of the Window.
+ */
+#define INTONATION_POWER_MIN		(10000000000.00)
+
+#ifdef HAVE_FFTW3_THREADS
+/* Set by tuner_intonation_init_threads(): 1 Threaded Plans, -1 Failed */
+static int fftw_threads = 0;
+#endif
+
+static const char *NOTE_NAMES[12] = {
+	"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+};
+
+struct _guitar_tuner_intonation {
+	int sampling_frequency;
+	unsigned int nsamples;
+	unsigned int hop;
+
+	/* Frequency Resolution (sampling rate / nsamples) */
+	double frequency;
+	double power_min;
+
+	/* Hann Window and the last nsamples Samples (8 Bit Amplitude),
+	 * ring_pos is the Oldest one, pending the Samples since the last
+	 * analyzed Window.
+	 */
+	double *window;
+	double *ring;
+	unsigned int ring_pos;
+	unsigned int pending;
+
+	double *fft_input;
+	double *fft_output;
+	double *power;
+	fftw_plan fft_plan;
+
+	/* Last Inharmonicity, used to Predict where the Partials are */
+	double inharmonicity;
+};
+
+/* Highest Local Maximum in (from, to), 0 if there's none */
+static unsigned int find_peak (const GuitarTunerIntonation *intonation,
+							   double from, double to)
+{
+	unsigned int last = intonation->nsamples / 2 - 2;
+	unsigned int k, kfrom, kto;
+	unsigned int peak = 0;
+
+	kfrom = (from < 1.0) ? 1 : (unsigned int) from;
+	kto = (to > last) ? last : (unsigned int) ceil(to);
+
+	for (k=kfrom + 1; k < kto; k++) {
+		if (intonation->power[k] <= intonation->power[k - 1]) continue;
+		if (intonation->power[k] < intonation->power[k + 1]) continue;
+
+		if (peak == 0 || intonation->power[k] > intonation->power[peak])
+			peak = k;
+	}
+
+	return(peak);
+}
+
+/* Frequency of the Peak at bin k, Parabola on the Log Power */
+static double interpolate_peak (const GuitarTunerIntonation *intonation, unsigned int k) {
+	const double *power = intonation->power;
+	double a, b, c, d, p = 0.0;
+
+	if (power[k - 1] <= 0.0 || power[k + 1] <= 0.0)
+		return((double) k * intonation->frequency);
+
+	a = log(power[k - 1]);
+	b = log(power[k]);
+	c = log(power[k + 1]);
+	d = a - 2.0 * b + c;
+	if (d < 0.0)
+		p = 0.5 * (a - c) / d;
+
+	return(((double) k + p) * intonation->frequency);
+}
+
+/* Least Squares B from f(n) / (n * f(1)) = sqrt((1 + B n^2) / (1 + B)) */
+static double fit_inharmonicity (const double *partials) {
+	double num = 0.0, den = 0.0;
+	double y, n2;
+	unsigned int n;
+
+	for (n=2; n <= TUNER_MAX_PARTIALS; n++) {
+		if (partials[n - 1] <= 0.0) continue;
+
+		y = partials[n - 1] / (n * partials[0]);
+		y *= y;
+		n2 = (double) n * n;
+
+		num += (y - 1.0) * (n2 - y);
+		den += (n2 - y) * (n2 - y);
+	}
+
+	/* Strings are never Stiffer than 0, a Negative B is Fit Noise */
+	if (den <= 0.0 || num <= 0.0)
+		return(0.0);
+
+	return(num / den);
+}
+
+static void intonation_analyze (GuitarTunerIntonation *intonation,
+								GuitarTunerIntonationResult *result)
+{
+	unsigned int nsamples = intonation->nsamples;
+	unsigned int tail = nsamples - intonation->ring_pos;
+	const double *output = intonation->fft_output;
+	double *power = intonation->power;
+	unsigned int i, k, kmin, kmax, kpeak, k1, h, n;
+	double f1, predicted, width, b, midi;
+
+	/* Oldest Sample First */
+	for (i=0; i < tail; i++)
+		intonation->fft_input[i] = intonation->ring[intonation->ring_pos + i] * intonation->window[i];
+	for (i=0; i < intonation->ring_pos; i++)
+		intonation->fft_input[tail + i] = intonation->ring[i] * intonation->window[tail + i];
+
+	/* Execute FFTW (Threaded Plan) */
+	fftw_execute(intonation->fft_plan);
+
+	power[0] = output[0] * output[0];
+	for (k=1; k < nsamples / 2; k++)
+		power[k] = output[k]*output[k] + output[nsamples - k]*output[nsamples - k];
+
+	result->note = NULL;
+	result->npartials = 0;
+	result->inharmonicity = 0.0;
+	for (n=0; n < TUNER_MAX_PARTIALS; n++) {
+		result->partials[n] = 0.0;
+		result->partials_cents[n] = 0.0;
+	}
+
+	/* Strongest Peak */
+	kmin = (unsigned int) ceil(INTONATION_MIN_FREQ / intonation->frequency);
+	kmax = (unsigned int) (INTONATION_MAX_FREQ / intonation->frequency);
+	if (kmin < 2) kmin = 2;
+	if (kmax > nsamples / 2 - 2) kmax = nsamples / 2 - 2;
+
+	/* Sampling Rate too Low for the Search Range */
+	if (kmin >= kmax) {
+		result->fundamental = 0.0;
+		result->reference_freq = 0.0;
+		result->cents = 0.0;
+		result->octave = 0;
+		return;
+	}
+
+	kpeak = kmin;
+	for (k=kmin; k < kmax; k++) {
+		if (power[k] > power[kpeak])
+			kpeak = k;
+	}
+
+	if (power[kpeak] <= intonation->power_min) {
+		result->fundamental = 0.0;
+		result->reference_freq = 0.0;
+		result->cents = 0.0;
+		result->octave = 0;
+		return;
+	}
+
+	/* The Strongest Peak may be an Harmonic, look for the Fundamental */
+	k1 = kpeak;
+	for (h=INTONATION_MAX_SUBHARMONIC; h >= 2; h--) {
+		predicted = (double) kpeak / h;
+		width = (0.02 * predicted < 2.0) ? 2.0 : 0.02 * predicted;
+		if (predicted - width < kmin) continue;
+
+		k = find_peak(intonation, predicted - width, predicted + width);
+		if (k != 0 && power[k] > power[kpeak] * INTONATION_SUBHARMONIC_MIN) {
+			k1 = k;
+			break;
+		}
+	}
+
+	/* Track the Partials, predicted with the Inharmonicity found so far */
+	f1 = interpolate_peak(intonation, k1);
+	result->partials[0] = f1;
+	result->npartials = 1;
+
+	b = intonation->inharmonicity;
+	width = 0.4 * f1 / intonation->frequency;
+	for (n=2; n <= TUNER_MAX_PARTIALS; n++) {
+		predicted = n * f1 * sqrt((1.0 + b * n * n) / (1.0 + b)) / intonation->frequency;
+		if (predicted + width >= nsamples / 2 - 2) break;
+
+		k = find_peak(intonation, predicted - width, predicted + width);
+		if (k == 0 || power[k] <= power[kpeak] * INTONATION_PARTIAL_MIN)
+			continue;
+
+		result->partials[n - 1] = interpolate_peak(intonation, k);
+		result->partials_cents[n - 1] = 1200.0 * log(result->partials[n - 1] / (n * f1)) / log(2.0);
+		result->npartials++;
+
+		b = fit_inharmonicity(result->partials);
+	}
+
+	if (result->npartials > 1) {
+		result->inharmonicity = b;
+		intonation->inharmonicity = b;
+	}
+
+	/* Nearest Equal Tempered Note */
+	midi = floor(69.0 + 12.0 * log(f1 / 440.0) / log(2.0) + 0.5);
+	result->fundamental = f1;
+	result->reference_freq = 440.0 * pow(2.0, (midi - 69.0) / 12.0);
+	result->cents = 1200.0 * log(f1 / result->reference_freq) / log(2.0);
+	result->note = NOTE_NAMES[(int) midi % 12];
+	result->octave = (int) midi / 12 - 1;
+}
+
+int tuner_intonation_init_threads (void) {
+#ifdef HAVE_FFTW3_THREADS
+	if (fftw_threads == 0)
+		fftw_threads = fftw_init_threads() ? 1 : -1;
+	return(fftw_threads > 0);
+#else
+	return(0);
+#endif
+}
+
+GuitarTunerIntonation *tuner_intonation_new (int sampling_frequency,
+											 unsigned int nsamples,
+											 unsigned int hop,
+											 int nthreads)
+{
+#ifdef HAVE_FFTW3_THREADS
+	int planner_nthreads = 1;
+#endif
+	GuitarTunerIntonation *intonation;
+	double scale;
+	unsigned int i;
+
+	if (sampling_frequency <= 0)
+		return(NULL);
+
+	if (nsamples == 0)
+		nsamples = TUNER_INTONATION_NSAMPLES;
+	else if (nsamples < NSAMPLES)
+		return(NULL);
+
+	if (hop == 0)
+		hop = sampling_frequency / 4;
+	if (hop == 0)
+		hop = 1;
+	if (hop > nsamples)
+		hop = nsamples;
+	if (nthreads <= 0)
+		nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads <= 0)
+		nthreads = 1;
+
+	if ((intonation = (GuitarTunerIntonation *) calloc(1, sizeof(GuitarTunerIntonation))) == NULL)
+		return(NULL);
+
+	intonation->sampling_frequency = sampling_frequency;
+	intonation->nsamples = nsamples;
+	intonation->hop = hop;
+	intonation->frequency = (double) sampling_frequency / nsamples;
+
+	scale = (double) nsamples / NSAMPLES;
+	intonation->power_min = INTONATION_POWER_MIN * scale * scale;
+
+	intonation->window = (double *) fftw_malloc(nsamples * sizeof(double));
+	intonation->ring = (double *) fftw_malloc(nsamples * sizeof(double));
+	intonation->fft_input = (double *) fftw_malloc(nsamples * sizeof(double));
+	intonation->fft_output = (double *) fftw_malloc(nsamples * sizeof(double));
+	intonation->power = (double *) fftw_malloc((nsamples / 2) * sizeof(double));
+	if (intonation->window == NULL || intonation->ring == NULL ||
+		intonation->fft_input == NULL || intonation->fft_output == NULL ||
+		intonation->power == NULL)
+	{
+		tuner_intonation_free(intonation);
+		return(NULL);
+	}
+
+	for (i=0; i < nsamples; i++) {
+		intonation->window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * (double) i / nsamples);
+		intonation->ring[i] = 0.0;
+	}
+
+#ifdef HAVE_FFTW3_THREADS
+	/* Threaded Plan, then the Host's Planner Threads back */
+	if (fftw_threads > 0) {
+#ifdef HAVE_FFTW_PLANNER_NTHREADS
+		planner_nthreads = fftw_planner_nthreads();
+#endif
+		fftw_plan_with_nthreads(nthreads);
+	}
+#endif
+
+	intonation->fft_plan = fftw_plan_r2r_1d(nsamples, intonation->fft_input,
+											intonation->fft_output,
+											FFTW_R2HC, FFTW_ESTIMATE);
+
+#ifdef HAVE_FFTW3_THREADS
+	if (fftw_threads > 0)
+		fftw_plan_with_nthreads(planner_nthreads);
+#endif
+
+	if (intonation->fft_plan == NULL) {
+		tuner_intonation_free(intonation);
+		return(NULL);
+	}
+
+	return(intonation);
+}
+
+void tuner_intonation_free (GuitarTunerIntonation *intonation) {
+	if (intonation == NULL)
+		return;
+
+	if (intonation->fft_plan != NULL)
+		fftw_destroy_plan(intonation->fft_plan);
+
+	fftw_free(intonation->window);
+	fftw_free(intonation->ring);
+	fftw_free(intonation->fft_input);
+	fftw_free(intonation->fft_output);
+	fftw_free(intonation->power);
+	free(intonation);
+}
+
+int tuner_intonation_process (GuitarTunerIntonation *intonation,
+							  const void *samples, size_t n,
+							  GuitarTunerFormat format,
+							  GuitarTunerIntonationResult *result)
+{
+	const unsigned char *input = (const unsigned char *) samples;
+	size_t sample_size;
+	unsigned int count;
+	double *ring;
+	int analyzed = 0;
+	unsigned int i;
+
+	if (intonation == NULL || result == NULL || (samples == NULL && n > 0))
+		return(-1);
+
+	if (format == TUNER_FORMAT_S16)
+		sample_size = sizeof(short);
+	else if (format == TUNER_FORMAT_U8)
+		sample_size = sizeof(unsigned char);
+	else
+		return(-1);
+
+	while (n > 0) {
+		/* Up to the next Window or the End of the Ring */
+		count = intonation->hop - intonation->pending;
+		if (count > intonation->nsamples - intonation->ring_pos)
+			count = intonation->nsamples - intonation->ring_pos;
+		if (n < count) count = (unsigned int) n;
+
+		/* Same Amplitude of the Note Detection (8 Bit) */
+		ring = intonation->ring + intonation->ring_pos;
+		if (format == TUNER_FORMAT_S16) {
+			for (i=0; i < count; i++)
+				ring[i] = (double) ((const short *) input)[i] / 256.0;
+		} else {
+			for (i=0; i < count; i++)
+				ring[i] = (double) input[i] - 128.0;
+		}
+
+		intonation->ring_pos = (intonation->ring_pos + count) % intonation->nsamples;
+		intonation->pending += count;
+		input += count * sample_size;
+		n -= count;
+
+		if (intonation->pending == intonation->hop) {
+			intonation_analyze(intonation, result);
+			intonation->pending = 0;
+			analyzed = 1;
+		}
+	}
+
+	return(analyzed);
+}
+
+#else /* TUNER_FIXED_POINT */
+
+/* Intonation Mode needs FFTW */
+int tuner_intonation_init_threads (void) {
+	return(0);
+}
+
+GuitarTunerIntonation *tuner_intonation_new (int sampling_frequency,
+											 unsigned int nsamples,
+											 unsigned int hop,
+											 int nthreads)
+{
+	return(NULL);
+}
+
+void tuner_intonation_free (GuitarTunerIntonation *intonation) {
+}
+
+int tuner_intonation_process (GuitarTunerIntonation *intonation,
+							  const void *samples, size_t n,
+							  GuitarTunerFormat format,
+							  GuitarTunerIntonationResult *result)
+{
+	return(-1);
+}
+
+#endif /* !TUNER_FIXED_POINT */
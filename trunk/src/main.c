@@ -16,85 +16,258 @@
  *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <pthread.h>
 #include <unistd.h>
 
 #include <gtk/gtk.h>
 #include <glib.h>
 
-#include "tuner.h"
+#include "guitartuner.h"
+#include "device.h"
 #include "gui.h"
 
+/* Intonation Mode: In Tune within half a Cent */
+#define INTONATION_IN_TUNE		(0.5)
+
+/* Startup Time Measurement (-t), Reported on stderr */
+static GTimeVal startup_time;
+static int startup_measure = 0;
+
+static void tuner_startup_report (const char *what) {
+	GTimeVal now;
+
+	g_get_current_time(&now);
+	fprintf(stderr, "%s: %.1f ms\n", what,
+			(now.tv_sec - startup_time.tv_sec) * 1000.0 +
+			(now.tv_usec - startup_time.tv_usec) / 1000.0);
+}
+
+static gboolean on_startup_map (GtkWidget *widget, GdkEvent *event, gpointer data) {
+	tuner_startup_report("Time to Window");
+	return(FALSE);
+}
+
+/* First Analyzed Frame, with the GDK thread lock held */
+static void tuner_startup_reading (void) {
+	if (!startup_measure)
+		return;
+
+	startup_measure = 0;
+	tuner_startup_report("Time to First Reading");
+	gtk_main_quit();
+}
+
+/* Show "No Note", with the GDK thread lock held */
+static void tuner_show_empty (GuitarTunerGUI *gui) {
+	guitar_tuner_gui_set_image(gui, gui->image_note, 
+							   &(gui->image_note_pixmap), GUI_PIXMAP_EMPTY);
+	guitar_tuner_gui_set_image(gui, gui->image_sharp, 
+							   &(gui->image_sharp_pixmap), GUI_PIXMAP_NOSHARP);
+	gtk_label_set_markup(GTK_LABEL(gui->label_actual_freq), "---.-- Hz");
+	gtk_label_set_markup(GTK_LABEL(gui->label_reference_freq), "---.-- Hz");
+}
+
+/* Show the Note, with the GDK thread lock held */
+static void tuner_show_result (GuitarTunerGUI *gui, const GuitarTunerResult *result) {
+	char buffer[256];
+
+	/* Reference Freq */
+	snprintf(buffer, 256, "%3.2f Hz", result->reference_freq);
+	gtk_label_set_markup(GTK_LABEL(gui->label_reference_freq), buffer);
+
+	/* Actual Freq */
+	snprintf(buffer, 256, "%3.2f Hz", result->actual_freq);
+	gtk_label_set_markup(GTK_LABEL(gui->label_actual_freq), buffer);
+
+	/* Have Sharp */
+	if (result->note[1] == '#') {			
+		guitar_tuner_gui_set_image(gui, gui->image_sharp, 
+								   &(gui->image_sharp_pixmap), GUI_PIXMAP_SHARP);
+	} else {
+		guitar_tuner_gui_set_image(gui, gui->image_sharp, 
+								   &(gui->image_sharp_pixmap), GUI_PIXMAP_NOSHARP);
+	}
+
+	/* Set Note Image */
+	guitar_tuner_gui_set_image(gui, gui->image_note, &(gui->image_note_pixmap), 
+							   GUI_PIXMAP_NOTE(result->note[0]));
+
+	switch (result->adjust) {
+		case TUNER_ADJUST_NONE: {
+			guitar_tuner_gui_set_image(gui, gui->image_adjustament, 
+									   &(gui->image_adjustament_pixmap), GUI_NPIXMAPS);
+			break;
+		} case TUNER_ADJUST_DOWN: {
+			guitar_tuner_gui_set_image(gui, gui->image_adjustament, 
+									   &(gui->image_adjustament_pixmap), GUI_PIXMAP_DOWN);
+			break;
+		} case TUNER_ADJUST_UP: {
+			guitar_tuner_gui_set_image(gui, gui->image_adjustament, 
+									   &(gui->image_adjustament_pixmap), GUI_PIXMAP_UP);
+			break;
+		}
+	}
+}
+
+/* The Tuner Thread gives up: show why, with the GDK thread lock held */
+static void tuner_thread_failed (GuitarTunerGUI *gui, const char *status) {
+	gtk_label_set_markup(GTK_LABEL(gui->label_status), status);
+	if (startup_measure)
+		gtk_main_quit();
+}
+
+/* Open the Sound Device from the Tuner Thread, the Window is already
+ * up showing "Connecting..." while the Driver is Slow to Answer.
+ */
+static int tuner_thread_connect (GuitarTunerGUI *gui) {
+	GuitarTunerFormat format = TUNER_FORMAT_U8;
+	const char *status = "";
+	int ret = 0;
+
+	/* Intonation Mode wants the 16bit Dynamic */
+	if (gui->intonation_mode)
+		format = TUNER_FORMAT_S16;
+
+	if (tuner_sound_device_init(&(gui->device), gui->device_name, format) < 0) {
+		status = "<small>Sound Device Error</small>";
+		ret = -1;
+	} else if (gui->intonation_mode) {
+		gui->intonation = tuner_intonation_new(gui->device.sampling_frequency, 0, 0, 0);
+		if (gui->intonation == NULL) {
+			status = "<small>Intonation Mode is not Available</small>";
+			ret = -1;
+		}
+	} else if ((gui->tuner = tuner_new(gui->device.sampling_frequency)) == NULL) {
+		status = "<small>Tuner Error</small>";
+		ret = -1;
+	}
+
+	/* get GDK thread lock */
+	gdk_threads_enter();
+	if (ret < 0)
+		tuner_thread_failed(gui, status);
+	else
+		gtk_label_set_markup(GTK_LABEL(gui->label_status), status);
+	/* release GDK thread lock */
+	gdk_threads_leave();
+
+	return(ret);
+}
+
 void *tuner_thread_func (void *args) {
 	GuitarTunerGUI *gui = (GuitarTunerGUI *) args;
-	char buffer[256];
+	GuitarTunerResult result;
+	int ret;
 
-	while (1) {
-		if (!tuner_get_note(&(gui->tuner))) {
-			/* get GDK thread lock */
-			gdk_threads_enter();
+	if (tuner_thread_connect(gui) < 0) {
+		pthread_exit(NULL);
+		return(NULL);
+	}
 
-			gtk_image_set_from_file(GTK_IMAGE(gui->image_note), PIXMAPS_DIR "/Empty.png");
-			gtk_image_set_from_file(GTK_IMAGE(gui->image_sharp), PIXMAPS_DIR "/NoSharp.png");
-			gtk_label_set_markup(GTK_LABEL(gui->label_actual_freq), "---.-- Hz");
-			gtk_label_set_markup(GTK_LABEL(gui->label_reference_freq), "---.-- Hz");
+	while (1) {
+		ret = tuner_sound_device_read(&(gui->device), gui->tuner, &result);
 
+		/* get GDK thread lock */
+		gdk_threads_enter();
+		if (ret < 0) {
+			/* Read Error or End of File */
+			tuner_show_empty(gui);
+			tuner_thread_failed(gui, "<small>Sound Device Error</small>");
 			/* release GDK thread lock */
 			gdk_threads_leave();
-			continue;
+			break;
 		}
 
-		/* get GDK thread lock */
-		gdk_threads_enter();		
+		tuner_startup_reading();
+		if (result.note == NULL)
+			tuner_show_empty(gui);
+		else
+			tuner_show_result(gui, &result);
+		/* release GDK thread lock */
+		gdk_threads_leave();
+	}
 
-		/* Reference Freq */
-		snprintf(buffer, 256, "%3.2f Hz", gui->tuner.reference_freq);
-		gtk_label_set_markup(GTK_LABEL(gui->label_reference_freq), buffer);
+	pthread_exit(NULL);
+	return(NULL);
+}
 
-		/* Actual Freq */
-		snprintf(buffer, 256, "%3.2f Hz", gui->tuner.actual_freq);
-		gtk_label_set_markup(GTK_LABEL(gui->label_actual_freq), buffer);
+void *tuner_intonation_thread_func (void *args) {
+	GuitarTunerGUI *gui = (GuitarTunerGUI *) args;
+	GuitarTunerIntonationResult intonation;
+	GuitarTunerResult result;
+	char buffer[256];
+	int ret;
+
+	if (tuner_thread_connect(gui) < 0) {
+		pthread_exit(NULL);
+		return(NULL);
+	}
 
-		/* Have Sharp */
-		if (gui->tuner.note[1] == '#') {			
-			gtk_image_set_from_file(GTK_IMAGE(gui->image_sharp), PIXMAPS_DIR "/Sharp.png");
-		} else {
-			gtk_image_set_from_file(GTK_IMAGE(gui->image_sharp), PIXMAPS_DIR "/NoSharp.png");
+	while (1) {
+		ret = tuner_sound_device_read_intonation(&(gui->device), gui->intonation, 
+												 &intonation);
+		if (ret < 0) {
+			/* Read Error or End of File, get GDK thread lock */
+			gdk_threads_enter();
+			tuner_show_empty(gui);
+			tuner_thread_failed(gui, "<small>Sound Device Error</small>");
+			/* release GDK thread lock */
+			gdk_threads_leave();
+			break;
 		}
 
-		/* Set Note Image */
-		snprintf(buffer, 256, "%s/%c.png", PIXMAPS_DIR, gui->tuner.note[0]);
-		gtk_image_set_from_file(GTK_IMAGE(gui->image_note), buffer);
-	
-		switch (gui->tuner.adjust) {
-			case TUNER_ADJUST_NONE: {
-				gtk_image_set_from_pixbuf(GTK_IMAGE(gui->image_adjustament), NULL);
-				break;
-			} case TUNER_ADJUST_DOWN: {
-				gtk_image_set_from_file(GTK_IMAGE(gui->image_adjustament), 
-										PIXMAPS_DIR "/Down.png");
-				break;
-			} case TUNER_ADJUST_UP: {
-				gtk_image_set_from_file(GTK_IMAGE(gui->image_adjustament), 
-										PIXMAPS_DIR "/Up.png");
-				break;
-			}
+		if (intonation.note == NULL) {
+			/* get GDK thread lock */
+			gdk_threads_enter();
+			tuner_startup_reading();
+			tuner_show_empty(gui);
+			gtk_label_set_markup(GTK_LABEL(gui->label_status), "");
+			/* release GDK thread lock */
+			gdk_threads_leave();
+			continue;
 		}
 
+		/* Equal Tempered Note, Adjust if more than Half a Cent off */
+		result.reference_freq = intonation.reference_freq;
+		result.actual_freq = intonation.fundamental;
+		result.note = intonation.note;
+		if (intonation.cents > INTONATION_IN_TUNE)
+			result.adjust = TUNER_ADJUST_DOWN;
+		else if (intonation.cents < -INTONATION_IN_TUNE)
+			result.adjust = TUNER_ADJUST_UP;
+		else
+			result.adjust = TUNER_ADJUST_NONE;
+
+		snprintf(buffer, 256, "<small>%s%d %+.2f cents, B = %.2e (%u partials)</small>",
+				 intonation.note, intonation.octave, intonation.cents,
+				 intonation.inharmonicity, intonation.npartials);
+
+		/* get GDK thread lock */
+		gdk_threads_enter();		
+		tuner_startup_reading();
+		tuner_show_result(gui, &result);
+		gtk_label_set_markup(GTK_LABEL(gui->label_status), buffer);
 		/* release GDK thread lock */
 		gdk_threads_leave();
 	}
 
-	/* Never Reached */
 	pthread_exit(NULL);
 	return(NULL);
 }
 
 int main (int argc, char **argv) {
 	const char *snd_device = NULL;
+	int intonation_mode = 0;
 	pthread_t tuner_thread;
 	GuitarTunerGUI gui;	
 
+	/* Startup Time is Measured from here */
+	g_get_current_time(&startup_time);
+
 	if (argc > 1) {
 		unsigned int i;
 
@@ -109,6 +282,8 @@ int main (int argc, char **argv) {
 				printf("   -h           Help. This Screen.\n");
 				printf("   -v           Print Version and Exit.\n");
 				printf("   -d <dev>     Select Sound (Input) Device\n");
+				printf("   -i           Intonation Mode (Long Windows, Partials)\n");
+				printf("   -t           Print Time to Window and to First Reading, then Exit\n");
 				printf("\n");
 				printf("Mail bug reports and suggestions to <theo.bertozzi@gmail.com>.\n");
 				return(0);
@@ -116,6 +291,12 @@ int main (int argc, char **argv) {
 				printf("%s %s\n", GUITAR_TUNER_NAME, GUITAR_TUNER_VERSION);
 				printf("Written by Matteo Bertozzi <theo.bertozzi@gmail.com>\n");
 				return(0);
+			} else if (argv[i][1] == 'i') {
+				/* Intonation Mode */
+				intonation_mode = 1;
+			} else if (argv[i][1] == 't') {
+				/* Startup Time Measurement */
+				startup_measure = 1;
 			} else if (argv[i][1] == 'd' && i++ < argc) {
 				/* Device */
 				snd_device = argv[i];
@@ -126,6 +307,10 @@ int main (int argc, char **argv) {
 		}
 	}
 
+	/* Threaded FFTW Plans, before any other FFTW Call */
+	if (intonation_mode)
+		tuner_intonation_init_threads();
+
 	/* Init Threads Support */
 	g_thread_init(NULL);
 	gdk_threads_init();
@@ -136,15 +321,27 @@ int main (int argc, char **argv) {
 
 	/* Load Guitar Tuner GUI */
 	guitar_tuner_gui_init(&gui);
-	
-	/* Init Tuner */
-	tuner_init(&gui.tuner);
-	if (tuner_sound_device_init(&gui.tuner, snd_device) < 0)
-		return(1);
-
-	/* Tuner Thread */
-	pthread_create(&tuner_thread, NULL, 
-			tuner_thread_func, &gui);
+	if (startup_measure) {
+		g_signal_connect(G_OBJECT(gui.window), "map-event",
+						 G_CALLBACK(on_startup_map), NULL);
+	}
+
+	/* Sound Device and Tuner are Opened by the Tuner Thread */
+	gui.tuner = NULL;
+	gui.intonation = NULL;
+	gui.intonation_mode = intonation_mode;
+	gui.device_name = snd_device;
+	gtk_label_set_markup(GTK_LABEL(gui.label_status), "<small>Connecting...</small>");
+
+	if (intonation_mode) {
+		/* Intonation Thread */
+		pthread_create(&tuner_thread, NULL, 
+				tuner_intonation_thread_func, &gui);
+	} else {
+		/* Tuner Thread */
+		pthread_create(&tuner_thread, NULL, 
+				tuner_thread_func, &gui);
+	}
 
 	/* End Of Gtk Loop and Threads... */
 	gtk_main();
@@ -0,0 +1,44 @@
+# [ mktables.awk ] - Guitar Tuner Window Tables
+# Generates tables.c at build time, so the tuner does no cos() at startup.
+#     awk -v nsamples=16384 -f mktables.awk > tables.c
+# The Q15 tables are in the fixed-point build, and in the float build
+# of guitartuner-bench (TUNER_FIXED_TABLES) that checks them.
+
+function floor(x, y) {
+	y = int(x)
+	return((y > x) ? y - 1 : y)
+}
+
+BEGIN {
+	pi = atan2(0, -1)
+
+	print "/* Generated by mktables.awk, Do Not Edit */"
+	print ""
+	print "#ifdef HAVE_CONFIG_H"
+	print "#include \"config.h\""
+	print "#endif"
+	print ""
+	print "#include \"tuner.h\""
+	print ""
+	printf("typedef char tables_nsamples_check[(NSAMPLES == %d) ? 1 : -1];\n", nsamples)
+	print ""
+
+	print "#if defined(TUNER_FIXED_POINT) || defined(TUNER_FIXED_TABLES)"
+	print "const short TUNER_FIXED_COSINE[NSAMPLES] = {"
+	for (i = 0; i < nsamples; i++)
+		printf("\t%d,\n", floor(32767.0 * cos(2.0 * pi * i / nsamples) + 0.5))
+	print "};"
+	print ""
+	print "const short TUNER_FIXED_WINDOW[NSAMPLES] = {"
+	for (i = 0; i < nsamples; i++)
+		printf("\t%d,\n", floor(32767.0 * (0.54 - 0.46 * cos(2.0 * pi * i / nsamples)) + 0.5))
+	print "};"
+	print "#endif"
+	print ""
+	print "#ifndef TUNER_FIXED_POINT"
+	print "const double TUNER_WINDOW[NSAMPLES] = {"
+	for (i = 0; i < nsamples; i++)
+		printf("\t%.17g,\n", 0.54 - 0.46 * cos(2.0 * pi * i / nsamples))
+	print "};"
+	print "#endif"
+}
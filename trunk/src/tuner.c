@@ -18,24 +18,16 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 /* Standard Headers */
-#include <math.h>
 #include <stdio.h>
-#include <fcntl.h>
 #include <stdlib.h>
-#include <unistd.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <sys/ioctl.h>
-#include <sys/soundcard.h>
-
-/* Fourier Transform Header */
-#include <fftw3.h>
 
 #include "tuner.h"
 
-const char *DEFAULT_DEVICE_AUDIO = "/dev/dsp";
-
 /* STANDARD FREQUENCIES (Hz) OF MUSICAL NOTES FOR INSTRUMENTS EXCEPT PIANO
  *  OCT
  * +---+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+
@@ -50,96 +42,127 @@ const char *DEFAULT_DEVICE_AUDIO = "/dev/dsp";
  * | 8 | 4186.0 | 4434.9 | 4698.6 | 4978.0 | 5274.0 | 5587.7 | 5919.9 | 6271.9 | 6644.9 | 7040.0 | 7458.6 | 7902.1 | 
  * +---+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+
  */
-Note NOTES[] = {
-	{"C", 64.406},
-	{"C", 130.81},
-	{"C", 261.63},
-	{"C", 523.25},
-	{"C", 1046.5},
-	{"C#", 69.296},
-	{"C#", 138.59},
-	{"C#", 277.18},
-	{"C#", 554.37},
-	{"C#", 1108.7},
-	{"D", 73.416},
-	{"D", 146.83},
-	{"D", 293.66},
-	{"D", 587.33},
-	{"D", 1174.7},
-	{"D#", 77.782},
-	{"D#", 155.56},
-	{"D#", 311.13},
-	{"D#", 622.25},
-	{"D#", 1244.5},
-	{"E", 82.407},
-	{"E", 164.81},
-	{"E", 329.63},
-	{"E", 659.26},
-	{"E", 1318.5},
-	{"F", 87.307},
-	{"F", 174.61},
-	{"F", 349.23},
-	{"F", 698.46},
-	{"F", 1396.9},
-	{"F#", 92.499},
-	{"F#", 185.00},
-	{"F#", 369.99},
-	{"F#", 739.99},
-	{"F#", 1480.0},
-	{"G", 97.999},
-	{"G", 196.00},
-	{"G", 392.00},
-	{"G", 783.99},
-	{"G", 1568.0},
-	{"G#", 103.83},
-	{"G#", 207.65},
-	{"G#", 415.30},
-	{"G#", 830.61},
-	{"G#", 1661.2},
-	{"A", 55},
-	{"A", 110},
-	{"A", 220},
-	{"A", 440},
-	{"A", 880},
-	{"A", 1760},
-	{"A#", 58.270},
-	{"A#", 116.54},
-	{"A#", 233.08},
-	{"A#", 466.16},
-	{"A#", 932.33},
-	{"A#", 1864.7},
-	{"B", 61.735},
-	{"B", 123.47},
-	{"B", 246.94},
-	{"B", 493.88},
-	{"B", 987.77}
+static const Note NOTES[] = {
+	{"C", TUNER_HZ(64.406)},
+	{"C", TUNER_HZ(130.81)},
+	{"C", TUNER_HZ(261.63)},
+	{"C", TUNER_HZ(523.25)},
+	{"C", TUNER_HZ(1046.5)},
+	{"C#", TUNER_HZ(69.296)},
+	{"C#", TUNER_HZ(138.59)},
+	{"C#", TUNER_HZ(277.18)},
+	{"C#", TUNER_HZ(554.37)},
+	{"C#", TUNER_HZ(1108.7)},
+	{"D", TUNER_HZ(73.416)},
+	{"D", TUNER_HZ(146.83)},
+	{"D", TUNER_HZ(293.66)},
+	{"D", TUNER_HZ(587.33)},
+	{"D", TUNER_HZ(1174.7)},
+	{"D#", TUNER_HZ(77.782)},
+	{"D#", TUNER_HZ(155.56)},
+	{"D#", TUNER_HZ(311.13)},
+	{"D#", TUNER_HZ(622.25)},
+	{"D#", TUNER_HZ(1244.5)},
+	{"E", TUNER_HZ(82.407)},
+	{"E", TUNER_HZ(164.81)},
+	{"E", TUNER_HZ(329.63)},
+	{"E", TUNER_HZ(659.26)},
+	{"E", TUNER_HZ(1318.5)},
+	{"F", TUNER_HZ(87.307)},
+	{"F", TUNER_HZ(174.61)},
+	{"F", TUNER_HZ(349.23)},
+	{"F", TUNER_HZ(698.46)},
+	{"F", TUNER_HZ(1396.9)},
+	{"F#", TUNER_HZ(92.499)},
+	{"F#", TUNER_HZ(185.00)},
+	{"F#", TUNER_HZ(369.99)},
+	{"F#", TUNER_HZ(739.99)},
+	{"F#", TUNER_HZ(1480.0)},
+	{"G", TUNER_HZ(97.999)},
+	{"G", TUNER_HZ(196.00)},
+	{"G", TUNER_HZ(392.00)},
+	{"G", TUNER_HZ(783.99)},
+	{"G", TUNER_HZ(1568.0)},
+	{"G#", TUNER_HZ(103.83)},
+	{"G#", TUNER_HZ(207.65)},
+	{"G#", TUNER_HZ(415.30)},
+	{"G#", TUNER_HZ(830.61)},
+	{"G#", TUNER_HZ(1661.2)},
+	{"A", TUNER_HZ(55)},
+	{"A", TUNER_HZ(110)},
+	{"A", TUNER_HZ(220)},
+	{"A", TUNER_HZ(440)},
+	{"A", TUNER_HZ(880)},
+	{"A", TUNER_HZ(1760)},
+	{"A#", TUNER_HZ(58.270)},
+	{"A#", TUNER_HZ(116.54)},
+	{"A#", TUNER_HZ(233.08)},
+	{"A#", TUNER_HZ(466.16)},
+	{"A#", TUNER_HZ(932.33)},
+	{"A#", TUNER_HZ(1864.7)},
+	{"B", TUNER_HZ(61.735)},
+	{"B", TUNER_HZ(123.47)},
+	{"B", TUNER_HZ(246.94)},
+	{"B", TUNER_HZ(493.88)},
+	{"B", TUNER_HZ(987.77)}
 };
-unsigned int NUM_NOTES = sizeof(NOTES) / sizeof(Note);
+static const unsigned int NUM_NOTES = sizeof(NOTES) / sizeof(Note);
+
+#ifdef TUNER_FIXED_POINT
+/* Window count Samples into the Current Frame, Integer Only */
+static void load_samples (GuitarTuner *tuner, const void *samples, 
+						  unsigned int count, GuitarTunerFormat format)
+{
+	if (format == TUNER_FORMAT_S16) {
+		fixed_load_s16(tuner->fft_data + tuner->fill, (const short *) samples,
+					   TUNER_FIXED_WINDOW + tuner->fill, count);
+	} else {
+		fixed_load_u8(tuner->fft_data + tuner->fill, (const unsigned char *) samples,
+					  TUNER_FIXED_WINDOW + tuner->fill, count);
+	}
+}
 
-/* Get Data From Device */
-static void get_data_from_device (GuitarTuner *tuner) {
-	unsigned char input[NSAMPLES];
-	double dinput[NSAMPLES];
-	double output[NSAMPLES];	
+/* Find the Spectrum Peak, Integer Only */
+static void process_frame (GuitarTuner *tuner) {
+	fixed_fft(tuner->fft_data, TUNER_FIXED_COSINE, NSAMPLES);
+
+	tuner->max_index = fixed_peak(tuner->fft_data, TUNER_FIXED_COSINE, 
+								  NSAMPLES, 2, NSAMPLES/16, &tuner->max);
+}
+#else
+/* Window count Samples into the Current Frame */
+static void load_samples (GuitarTuner *tuner, const void *samples, 
+						  unsigned int count, GuitarTunerFormat format)
+{
+	double *dinput = tuner->fft_input + tuner->fill;
+	const double *window = TUNER_WINDOW + tuner->fill;
 	unsigned int i;
-	fftw_plan p;
-	double tmp;
 
-	/* Read Device Data */
-	if (read(tuner->fd, input, (NSAMPLES * sizeof(unsigned char))) < 0) {
-		perror("read()");
-		return;
-	}
+	if (format == TUNER_FORMAT_S16) {
+		/* 16 Bit Samples (Scaled to the 8 Bit Amplitude) */
+		const short *input = (const short *) samples;
 
-	/* 8 Bit Samples */
-	for (i=0; i < NSAMPLES; i++) {		
-		dinput[i] = ((double) (input[i] - 128.0))*(0.54 - 0.46 * tuner->COSINE[i]);
+		for (i=0; i < count; i++) {
+			dinput[i] = ((double) input[i] / 256.0) * window[i];
+		}
+	} else {
+		/* 8 Bit Samples */
+		const unsigned char *input = (const unsigned char *) samples;
+
+		for (i=0; i < count; i++) {		
+			dinput[i] = ((double) (input[i] - 128.0)) * window[i];
+		}
 	}
+}
+
+/* Find the Spectrum Peak */
+static void process_frame (GuitarTuner *tuner) {
+	const double *output = tuner->fft_output;
+	unsigned int i;
+	double tmp;
 
 	/* Execute FFTW */
-	p = fftw_plan_r2r_1d(NSAMPLES, dinput, output, FFTW_R2HC, FFTW_ESTIMATE);
-	fftw_execute(p);
-	fftw_destroy_plan(p);
+	fftw_execute(tuner->fft_plan);
 
 	tuner->max = 0;
 	tuner->max_index = 0;
@@ -151,146 +174,161 @@ static void get_data_from_device (GuitarTuner *tuner) {
 		}
 	}
 }
-
-#if 0
-/* Controllo se per N volte le freq son state uguali */
-static double get_current_frequence (GuitarTuner *tuner) {
-	unsigned int max_index1;
-	unsigned int max_index2;	
-	double max1, max2;
-	unsigned int i;
-
-	do {
-		get_data_from_device(tuner);
-		max_index1 = tuner->max_index;
-		max1 = tuner->max;
-		for (i=0; i < 2; i++) {
-			get_data_from_device(tuner);
-			max_index2 = tuner->max_index;
-			max2 = tuner->max;
-
-			if (max_index1 != max_index2) break;
-			max_index1 = max_index2;
-			max1 = max2;
-		}
-	} while (i < 2);
-
-	tuner->max = max2;
-	tuner->max_index = max_index1;
-	return((double) max_index1 * tuner->frequency);
-}
 #endif
 
-int tuner_sound_device_init (GuitarTuner *tuner, const char *device) {
-	if (device == NULL)
-		device = DEFAULT_DEVICE_AUDIO;
-
-	/* Open Sound Device */
-	if ((tuner->fd = open(device, O_RDONLY)) < 0) {
-		perror("open()");
-		return(-1);
-	}
-
-	/* Channels Setting */
-	if (ioctl(tuner->fd, SNDCTL_DSP_CHANNELS, &tuner->channels) < 0) {
-		perror("Channels Setting - ioctl()");
-		goto snd_dev_err_close;
-	}
-
-	/* Sound Format */
-	if (ioctl(tuner->fd, SNDCTL_DSP_SETFMT, &tuner->format) < 0) {
-		perror("Sound Format - ioctl()");
-		goto snd_dev_err_close;
-	}
-
-	/* Sampling Rate */
-	if (ioctl(tuner->fd, SNDCTL_DSP_SPEED, &tuner->sampling_frequency) < 0) {
-		perror("Sampling Rate - ioctl()");
-		goto snd_dev_err_close;
-	}
-
-	/* All Seems OK, Return Device Descriptor */
-	return(tuner->fd);
-
-	/* Error: Close Snd Device and Return Error */
-snd_dev_err_close:
-	close(tuner->fd);
-	return(-1);
-}
-
-void tuner_init (GuitarTuner *tuner) {
-	unsigned int i;
-
-	tuner->fd = -1;
-	tuner->channels = 0;
-	tuner->format = AFMT_S8;
-	tuner->sampling_frequency = 22050;
-	tuner->frequency = ((double) tuner->sampling_frequency/NSAMPLES);
-
-	for (i=0; i < NSAMPLES; i++)
-		tuner->COSINE[i] = cos(2.0 * M_PI * (double) i / NSAMPLES);
-
-	tuner->reference_freq = 0.0;
-	tuner->actual_freq = 0.0;
-	tuner->note = NULL;
-	tuner->adjust = TUNER_ADJUST_NONE;
-}
-
-short int tuner_get_note (GuitarTuner *tuner) {	
-	double delta = 0;
+/* Map the Spectrum Peak to a Note */
+static void match_note (GuitarTuner *tuner) {
+	tuner_freq_t delta = 0;
 	unsigned int i;	
-	double freq;
+	tuner_freq_t freq;
+	tuner_freq_t dist;
 
-	get_data_from_device(tuner);
-	freq = (double) tuner->max_index * tuner->frequency;
+	freq = (tuner_freq_t) tuner->max_index * tuner->frequency;
 
 #ifdef DEBUG
-	fprintf(stderr, "Freq: %.3fHz (Index: %u)\n", freq, tuner->max_index);
+	fprintf(stderr, "Freq: %.3fHz (Index: %u)\n", TUNER_FREQ_TO_HZ(freq), tuner->max_index);
 #endif
 
 	/* Delta is How far off we can be from a given note 
 	 * (changes with octaves) It is Sharp or Flat.
 	 */
-	if (freq > 31 && freq < 63) delta = 2;
-	else if (freq > 63 && freq < 128) delta = 4;
-	else if (freq > 128 && freq < 192) delta = 8;
-	else if (freq > 192 && freq < 256) delta = 12;
-	else if (freq > 256 && freq < 384) delta = 16;
-	else if (freq > 384 && freq < 512) delta = 24;
-	else if (freq > 512 && freq < 1024) delta = 32;
-	else if (freq > 1024 && freq < 2048) delta = 64;
-	else if (freq > 2048 && freq < 5096) delta = 128;
-	else if (freq > 5096 && freq < 8100) delta = 256;
-
-
-	if (tuner->max <= (double) 10000000000.00) {
+	if (freq > TUNER_HZ(31) && freq < TUNER_HZ(63)) delta = TUNER_HZ(2);
+	else if (freq > TUNER_HZ(63) && freq < TUNER_HZ(128)) delta = TUNER_HZ(4);
+	else if (freq > TUNER_HZ(128) && freq < TUNER_HZ(192)) delta = TUNER_HZ(8);
+	else if (freq > TUNER_HZ(192) && freq < TUNER_HZ(256)) delta = TUNER_HZ(12);
+	else if (freq > TUNER_HZ(256) && freq < TUNER_HZ(384)) delta = TUNER_HZ(16);
+	else if (freq > TUNER_HZ(384) && freq < TUNER_HZ(512)) delta = TUNER_HZ(24);
+	else if (freq > TUNER_HZ(512) && freq < TUNER_HZ(1024)) delta = TUNER_HZ(32);
+	else if (freq > TUNER_HZ(1024) && freq < TUNER_HZ(2048)) delta = TUNER_HZ(64);
+	else if (freq > TUNER_HZ(2048) && freq < TUNER_HZ(5096)) delta = TUNER_HZ(128);
+	else if (freq > TUNER_HZ(5096) && freq < TUNER_HZ(8100)) delta = TUNER_HZ(256);
+
+
+	if (tuner->max <= TUNER_POWER_MIN) {
 		tuner->reference_freq = 0.0;
 		tuner->actual_freq = 0.0;
 		tuner->note = NULL;
 		tuner->adjust = TUNER_ADJUST_NONE;
-		return(0);
+		return;
 	}
 
 	for (i=0; i < NUM_NOTES; i++) {
-		if (fabs(NOTES[i].freq - freq) < delta/2) {
-			if (fabs(NOTES[i].freq - freq) < (tuner->frequency / 2.0)) {
-				tuner->reference_freq = NOTES[i].freq;
-				tuner->actual_freq = freq;
+		/* |NOTES[i].freq - freq|, unsigned safe */
+		dist = (NOTES[i].freq > freq) ? NOTES[i].freq - freq : freq - NOTES[i].freq;
+
+		if (dist < delta/2) {
+			if (dist < (tuner->frequency / 2)) {
+				tuner->reference_freq = TUNER_FREQ_TO_HZ(NOTES[i].freq);
+				tuner->actual_freq = TUNER_FREQ_TO_HZ(freq);
 				tuner->note = NOTES[i].label;
 				tuner->adjust = TUNER_ADJUST_NONE;
 			} else if (NOTES[i].freq < freq) {
-				tuner->reference_freq = NOTES[i].freq;
-				tuner->actual_freq = freq;
+				tuner->reference_freq = TUNER_FREQ_TO_HZ(NOTES[i].freq);
+				tuner->actual_freq = TUNER_FREQ_TO_HZ(freq);
 				tuner->note = NOTES[i].label;
 				tuner->adjust = TUNER_ADJUST_DOWN;
 			} else if (NOTES[i].freq > freq) {
-				tuner->reference_freq = NOTES[i].freq;
-				tuner->actual_freq = freq;
+				tuner->reference_freq = TUNER_FREQ_TO_HZ(NOTES[i].freq);
+				tuner->actual_freq = TUNER_FREQ_TO_HZ(freq);
 				tuner->note = NOTES[i].label;
 				tuner->adjust = TUNER_ADJUST_UP;
 			}
 		}
 	}
-	return(1);
+}
+
+GuitarTuner *tuner_new (int sampling_frequency) {
+	GuitarTuner *tuner;
+
+	if (sampling_frequency <= 0)
+		return(NULL);
+
+	if ((tuner = (GuitarTuner *) malloc(sizeof(GuitarTuner))) == NULL)
+		return(NULL);
+
+	/* Window Tables are in tables.c, nothing to compute here */
+	tuner->sampling_frequency = sampling_frequency;
+#ifdef TUNER_FIXED_POINT
+	tuner->frequency = (tuner_freq_t) (((unsigned long long) tuner->sampling_frequency << 16) / NSAMPLES);
+#else
+	tuner->frequency = ((double) tuner->sampling_frequency/NSAMPLES);
+
+	/* Plan Once, fftw_execute() is the only Thread Safe FFTW call */
+	tuner->fft_plan = fftw_plan_r2r_1d(NSAMPLES, tuner->fft_input, tuner->fft_output, 
+									   FFTW_R2HC, FFTW_ESTIMATE);
+	if (tuner->fft_plan == NULL) {
+		free(tuner);
+		return(NULL);
+	}
+#endif
+	tuner->fill = 0;
+
+	tuner->max_index = 0;
+	tuner->max = 0;
+
+	tuner->reference_freq = 0.0;
+	tuner->actual_freq = 0.0;
+	tuner->note = NULL;
+	tuner->adjust = TUNER_ADJUST_NONE;
+	return(tuner);
+}
+
+void tuner_free (GuitarTuner *tuner) {
+	if (tuner == NULL)
+		return;
+
+#ifndef TUNER_FIXED_POINT
+	fftw_destroy_plan(tuner->fft_plan);
+#endif
+	free(tuner);
+}
+
+int tuner_process (GuitarTuner *tuner,
+				   const void *samples, size_t n,
+				   GuitarTunerFormat format,
+				   GuitarTunerResult *result)
+{
+	const unsigned char *input = (const unsigned char *) samples;
+	size_t sample_size;
+	unsigned int count;
+	int analyzed = 0;
+
+	if (tuner == NULL || result == NULL || (samples == NULL && n > 0))
+		return(-1);
+
+	if (format == TUNER_FORMAT_S16)
+		sample_size = sizeof(short);
+	else if (format == TUNER_FORMAT_U8)
+		sample_size = sizeof(unsigned char);
+	else
+		return(-1);
+
+	while (n > 0) {
+		/* Fill the Current Frame */
+		count = NSAMPLES - tuner->fill;
+		if (n < count) count = (unsigned int) n;
+
+		load_samples(tuner, input, count, format);
+		tuner->fill += count;
+		input += count * sample_size;
+		n -= count;
+
+		/* Frame Complete, Analyze it */
+		if (tuner->fill == NSAMPLES) {
+			process_frame(tuner);
+			match_note(tuner);
+			tuner->fill = 0;
+			analyzed = 1;
+		}
+	}
+
+	if (analyzed) {
+		result->reference_freq = tuner->reference_freq;
+		result->actual_freq = tuner->actual_freq;
+		result->note = tuner->note;
+		result->adjust = tuner->adjust;
+	}
+
+	return(analyzed);
 }
 
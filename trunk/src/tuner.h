@@ -21,31 +21,61 @@
 #ifndef __GUITAR_TUNER_H__
 #define __GUITAR_TUNER_H__
 
-#define NSAMPLES		(16384)	/* 16K -> 16384 */
+/* libguitartuner Internals, the Public API is in guitartuner.h */
+#include "guitartuner.h"
 
-typedef struct _note {
-	char label[3];
-	double freq; 
-} Note;
+#ifdef TUNER_FIXED_POINT
+/* Integer DSP Header */
+#include "fixed.h"
+#else
+/* Fourier Transform Header */
+#include <fftw3.h>
+#endif
 
-typedef enum _tuner_adjust {
-	TUNER_ADJUST_NONE,
-	TUNER_ADJUST_DOWN,
-	TUNER_ADJUST_UP
-} GuitarTunerAdjust;
+#define NSAMPLES		(16384)	/* 16K -> 16384 */
 
-typedef struct _guitar_tuner {
-	/* Device Descriptor */
-	int fd;
+/* Frequencies and Powers are double, or integers when configured
+ * with --enable-fixed-point for the boards without FPU.
+ * TUNER_HZ() converts a constant in Hz to tuner_freq_t at compile time.
+ */
+#ifdef TUNER_FIXED_POINT
+typedef unsigned int tuner_freq_t;	/* Q16.16 Hz */
+typedef long long tuner_power_t;
+#define TUNER_HZ(hz)			((tuner_freq_t) ((hz) * 65536.0 + 0.5))
+#define TUNER_FREQ_TO_HZ(freq)	((double) (freq) / 65536.0)
+#else
+typedef double tuner_freq_t;
+typedef double tuner_power_t;
+#define TUNER_HZ(hz)			((double) (hz))
+#define TUNER_FREQ_TO_HZ(freq)	(freq)
+#endif
 
-	/* Channels: (Mono = 0, Stereo = 1) */
-	int channels;
+/* Below this Power there's no Note (Only Noise) */
+#ifdef TUNER_FIXED_POINT
+#define TUNER_POWER_MIN		(10000000000LL * FIXED_POWER_SCALE)
+#else
+#define TUNER_POWER_MIN		(10000000000.00)
+#endif
 
-	/* AFMT_S8 is the Default 8bit Format
-	 * You Must use Unsigned Char for the Data Read (in[N])
-	 */
-	int format;
+/* Window Tables, generated at build time by mktables.awk (tables.c)
+ *     TUNER_WINDOW[i] = 0.54 - 0.46 * cos(2.0 * M_PI * i / NSAMPLES);
+ * and the same in Q15, with the cosine for the FFT Twiddles.
+ * TUNER_FIXED_TABLES adds the Q15 ones to a float build (the bench).
+ */
+#if defined(TUNER_FIXED_POINT) || defined(TUNER_FIXED_TABLES)
+extern const short TUNER_FIXED_COSINE[NSAMPLES];
+extern const short TUNER_FIXED_WINDOW[NSAMPLES];
+#endif
+#ifndef TUNER_FIXED_POINT
+extern const double TUNER_WINDOW[NSAMPLES];
+#endif
+
+typedef struct _note {
+	char label[3];
+	tuner_freq_t freq; 
+} Note;
 
+struct _guitar_tuner {
 	/* Sampleing Rate is Sampling Frequecy of the Microphone in Hz
 	 * Lowering this Value will Lower f and improve your resolution.
 	 * But it will alsa limit the highest frequency you can detect...
@@ -59,25 +89,29 @@ typedef struct _guitar_tuner {
 	 * Increasing this value will Improve your Frequence Resolution.
 	 * But if you make it too large, it takes longer to get each sample.
 	 */	
-	double frequency;
+	tuner_freq_t frequency;
 
-	/* cosine is just an array of cos values used to improve performance 
-	 *     COSINE[i] = cos(2.0 * M_PI * (double) i / NSAMPLES);
+	/* Pushed samples are windowed straight into the FFT input,
+	 * fill is how many samples of the current frame are there.
 	 */
-	double COSINE[NSAMPLES];
+#ifdef TUNER_FIXED_POINT
+	/* FFT Work Buffer (see fixed.h) */
+	int fft_data[NSAMPLES];
+#else
+	double fft_input[NSAMPLES];
+	double fft_output[NSAMPLES];
+	fftw_plan fft_plan;
+#endif
+	unsigned int fill;
 
 	unsigned int max_index;
-	double max;
+	tuner_power_t max;
 
-	/* Frequence & Adjustament */
+	/* Frequence & Adjustament (Last Frame) */
 	double reference_freq;
 	double actual_freq;
 	const char *note;
 	GuitarTunerAdjust adjust;
-} GuitarTuner;
-
-void tuner_init (GuitarTuner *tuner);
-int tuner_sound_device_init (GuitarTuner *tuner, const char *device);
-short int tuner_get_note (GuitarTuner *tuner);
+};
 
 #endif /* !__GUITAR_TUNER_H__ */